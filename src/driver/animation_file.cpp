@@ -0,0 +1,213 @@
+#include "./animation_file.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+enum { AnimationVersion = 2 };
+
+
+/**********************************************
+ *
+ *   AnimationWriter
+ *
+**********************************************/
+bool AnimationWriter::open(const std::string& filename, uint32_t keyInterval) {
+    close();
+    fp_ = fopen(filename.c_str(), "wb");
+    if (!fp_)
+        return false;
+
+    // written again by close()
+    AnimationHeader header = {};
+    ok_ = fwrite(&header, sizeof(header), 1, fp_) == 1;
+    keyInterval_ = keyInterval > 0 ? keyInterval : 1;
+    frameCount_ = 0;
+    totalUs_ = 0;
+    offset_ = sizeof(header);
+    index_.clear();
+    hasPending_ = false;
+    return ok_;
+}
+
+void AnimationWriter::record(const Frame& leds, const uint64_t levels[8][LevelBits], uint64_t timeNs) {
+    if (!fp_)
+        return;
+
+    uint64_t words[FrameCodec::Words];
+    FrameCodec::pack(leds, levels, words);
+
+    if (hasPending_) {
+        if (memcmp(pending_, words, sizeof(words)) == 0)
+            return;
+        writePending(uint32_t((timeNs - pendingNs_) / 1000));
+    }
+
+    memcpy(pending_, words, sizeof(words));
+    pendingNs_ = timeNs;
+    hasPending_ = true;
+}
+
+bool AnimationWriter::writePending(uint32_t durationUs) {
+    uint8_t buffer[10 + FrameCodec::MaxEncodedSize];
+    uint8_t* out = FrameCodec::putVarint(buffer, durationUs);
+
+    if (frameCount_ % keyInterval_ == 0) {
+        index_.push_back(offset_);
+        FrameCodec::keyReference(written_);
+    }
+    out += FrameCodec::encode(pending_, written_, out);
+
+    size_t size = out - buffer;
+    ok_ = ok_ && fwrite(buffer, 1, size, fp_) == size;
+
+    memcpy(written_, pending_, sizeof(written_));
+    offset_ += size;
+    ++frameCount_;
+    totalUs_ += durationUs;
+    return ok_;
+}
+
+bool AnimationWriter::close() {
+    if (!fp_)
+        return false;
+
+    if (hasPending_) {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        uint64_t now = uint64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+        writePending(uint32_t((now - pendingNs_) / 1000));
+        hasPending_ = false;
+    }
+
+    // keyframe index, 8 bytes aligned
+    uint64_t padding = 0;
+    size_t paddingSize = (8 - offset_ % 8) % 8;
+    ok_ = ok_ && fwrite(&padding, 1, paddingSize, fp_) == paddingSize;
+    offset_ += paddingSize;
+    ok_ = ok_ && fwrite(index_.data(), sizeof(uint64_t), index_.size(), fp_) == index_.size();
+
+    AnimationHeader header = {};
+    memcpy(header.magic, "LCAN", 4);
+    header.version = AnimationVersion;
+    header.encoding = ANIMATION_DELTA;
+    header.frameCount = frameCount_;
+    header.keyInterval = keyInterval_;
+    header.totalUs = totalUs_;
+    header.indexOffset = offset_;
+    header.indexCount = uint32_t(index_.size());
+    ok_ = ok_ && fseek(fp_, 0, SEEK_SET) == 0;
+    ok_ = ok_ && fwrite(&header, sizeof(header), 1, fp_) == 1;
+    ok_ = (fclose(fp_) == 0) && ok_;
+    fp_ = nullptr;
+    return ok_;
+}
+
+
+/**********************************************
+ *
+ *   AnimationReader
+ *
+**********************************************/
+bool AnimationReader::open(const std::string& filename) {
+    close();
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(AnimationHeader)) {
+        ::close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+        return false;
+
+    const AnimationHeader* header = static_cast<const AnimationHeader*>(map);
+    bool ok = memcmp(header->magic, "LCAN", 4) == 0 &&
+              header->version == AnimationVersion &&
+              header->encoding == ANIMATION_DELTA &&
+              header->keyInterval > 0 &&
+              header->indexOffset % 8 == 0 &&
+              header->indexOffset <= size &&
+              header->indexCount <= (size - header->indexOffset) / sizeof(uint64_t) &&
+              header->indexCount == (header->frameCount + header->keyInterval - 1) / header->keyInterval;
+    if (!ok) {
+        munmap(map, size);
+        return false;
+    }
+
+    // played from the beginning to the end, read ahead
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    map_ = map;
+    size_ = size;
+    header_ = header;
+    index_ = reinterpret_cast<const uint64_t*>(static_cast<const char*>(map) + header->indexOffset);
+    rewind();
+    return true;
+}
+
+void AnimationReader::close() {
+    if (map_)
+        munmap(map_, size_);
+    map_ = nullptr;
+    size_ = 0;
+    header_ = nullptr;
+    index_ = nullptr;
+}
+
+bool AnimationReader::seek(uint32_t i) {
+    if (!header_ || i > header_->frameCount)
+        return false;
+
+    // from the keyframe before frame i
+    uint32_t key = i / header_->keyInterval;
+    if (key >= header_->indexCount) {
+        // the end
+        frameIndex_ = header_->frameCount;
+        pos_ = header_->indexOffset;
+        return true;
+    }
+    frameIndex_ = key * header_->keyInterval;
+    pos_ = index_[key];
+    uint32_t durationUs;
+    while (frameIndex_ < i) {
+        if (!decodeNext(durationUs))
+            return false;
+    }
+    return true;
+}
+
+bool AnimationReader::decodeNext(uint32_t& durationUs) {
+    if (!header_ || frameIndex_ >= header_->frameCount)
+        return false;
+
+    const uint8_t* data = static_cast<const uint8_t*>(map_);
+    const uint8_t* in = data + pos_;
+    const uint8_t* end = data + header_->indexOffset;
+
+    uint64_t duration;
+    if (!(in = FrameCodec::getVarint(in, end, duration)))
+        return false;
+    if (frameIndex_ % header_->keyInterval == 0)
+        FrameCodec::keyReference(words_);
+    if (!(in = FrameCodec::decode(in, end, words_)))
+        return false;
+
+    durationUs = uint32_t(duration);
+    pos_ = in - data;
+    ++frameIndex_;
+    return true;
+}
+
+bool AnimationReader::next(TimedFrame& frame) {
+    if (!decodeNext(frame.durationUs))
+        return false;
+    FrameCodec::unpack(words_, frame.leds, frame.levels);
+    return true;
+}
+
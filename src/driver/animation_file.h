@@ -0,0 +1,119 @@
+#pragma once
+#include "./frame_stream.h"
+#include "../utility/frame_codec.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+
+/*************************************************************
+ *   Recorded animation (.lca)
+ *
+ *     AnimationHeader
+ *     records, one per frame:
+ *       varint   durationUs
+ *       bytes    the frame, FrameCodec encoded against the
+ *                previous frame (a keyframe every keyInterval
+ *                frames: against FrameCodec::keyReference())
+ *     index: uint64_t offset of each keyframe
+ *
+ *   Native byte order (the Pi and PCs are little-endian).
+*************************************************************/
+struct AnimationHeader {
+    char magic[4];          // "LCAN"
+    uint16_t version;
+    uint16_t encoding;      // AnimationEncoding
+    uint32_t frameCount;
+    uint32_t keyInterval;   // frame i is a keyframe if i % keyInterval == 0
+    uint64_t totalUs;
+    uint64_t indexOffset;   // from the beginning of the file
+    uint32_t indexCount;
+    uint32_t reserved;
+};
+
+enum AnimationEncoding {
+    ANIMATION_DELTA = 1,    // FrameCodec
+};
+
+
+/*************************************************************
+ *   AnimationWriter
+ *     record(): a frame was published at timeNs, it lasts
+ *     until the next one (or close())
+ *     identical consecutive frames are merged
+*************************************************************/
+class AnimationWriter {
+public:
+    enum { DefaultKeyInterval = 64 };
+
+    AnimationWriter() {}
+    ~AnimationWriter() { close(); }
+
+    AnimationWriter(const AnimationWriter&) = delete;
+    AnimationWriter& operator=(const AnimationWriter&) = delete;
+
+    bool open(const std::string& filename, uint32_t keyInterval = DefaultKeyInterval);
+    void record(const Frame& leds, const uint64_t levels[8][LevelBits], uint64_t timeNs);
+    // write the last frame and the header
+    bool close();
+
+    bool isOpen() const { return fp_ != nullptr; }
+    uint32_t frameCount() const { return frameCount_; }
+
+private:
+    bool writePending(uint32_t durationUs);
+
+    FILE* fp_ = nullptr;
+    bool ok_ = true;
+    uint32_t keyInterval_ = DefaultKeyInterval;
+    uint32_t frameCount_ = 0;
+    uint64_t totalUs_ = 0;
+    uint64_t offset_ = 0;                   // of the next record
+    std::vector<uint64_t> index_;           // offsets of the keyframes
+
+    uint64_t written_[FrameCodec::Words];   // the last frame written
+    uint64_t pending_[FrameCodec::Words];   // the last frame, its duration not yet known
+    uint64_t pendingNs_ = 0;
+    bool hasPending_ = false;
+};
+
+
+/*************************************************************
+ *   AnimationReader
+ *     the file is mmap-ed, next() decodes frames in place
+ *     (no allocation per frame)
+*************************************************************/
+class AnimationReader {
+public:
+    AnimationReader() {}
+    ~AnimationReader() { close(); }
+
+    AnimationReader(const AnimationReader&) = delete;
+    AnimationReader& operator=(const AnimationReader&) = delete;
+
+    bool open(const std::string& filename);
+    void close();
+
+    // the next frame, false at the end (or if the file is broken)
+    bool next(TimedFrame& frame);
+    // back to the first frame
+    void rewind() { seek(0); }
+    // next() returns frame i, decoded from the keyframe before it
+    bool seek(uint32_t i);
+
+    uint32_t frameCount() const { return header_ ? header_->frameCount : 0; }
+    uint64_t totalUs() const { return header_ ? header_->totalUs : 0; }
+
+private:
+    bool decodeNext(uint32_t& durationUs);
+
+    void* map_ = nullptr;
+    size_t size_ = 0;
+    const AnimationHeader* header_ = nullptr;
+    const uint64_t* index_ = nullptr;
+    size_t pos_ = 0;
+    uint32_t frameIndex_ = 0;
+    uint64_t words_[FrameCodec::Words];
+};
+
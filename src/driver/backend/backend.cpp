@@ -0,0 +1,30 @@
+#include "./backend.h"
+#include "./simulator_backend.h"
+#include "./gpiomem_backend.h"
+#ifdef LEDCUBE_WITH_WIRINGPI
+#include "./wiringpi_backend.h"
+#endif
+
+
+CubeBackend* createBackend(const std::string& name) {
+#ifdef LEDCUBE_WITH_WIRINGPI
+    if (name == "wiringpi")
+        return new WiringPiBackend();
+#endif
+    if (name == "gpiomem")
+        return new GpioMemBackend();
+    if (name == "sim")
+        return new SimulatorBackend();
+    if (name.substr(0, 4) == "sim:")
+        return new SimulatorBackend(name.substr(4));
+    return nullptr;
+}
+
+const char* defaultBackendName() {
+#ifdef LEDCUBE_WITH_WIRINGPI
+    return "wiringpi";
+#else
+    return "sim";
+#endif
+}
+
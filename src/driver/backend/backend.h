@@ -0,0 +1,69 @@
+#pragma once
+#include "../../utility/frame.h"
+#include <string>
+
+
+/**********************************************************
+ *   Wiring of the cube (BCM GPIO numbers)
+ *     4 x 74HC154 share the address pins A B C D,
+ *     each one has its own enable pin G
+ *     8 layers, each one has its own VCC pin
+**********************************************************/
+struct CubePins {
+    int a = 17;
+    int b = 27;
+    int c = 22;
+    int d = 5;
+    int g[4]   = { 6, 13, 19, 26 };
+    int vcc[8] = { 18, 23, 24, 25, 12, 16, 20, 21 };
+};
+
+
+/**********************************************************
+ *   CubeBackend
+ *     where the frames of LedCube go
+ *
+ *   Scanned backends (real hardware) are driven by the
+ *   background thread of LedCube:
+ *     powerLayer(z, true)
+ *       lightOn(decoder, code) ... lightOff(decoder)
+ *     powerLayer(z, false)
+ *   led (x, y, z) <==> decoder x / 2, output y + 8 * (x % 2)
+**********************************************************/
+class CubeBackend {
+public:
+    virtual ~CubeBackend() {}
+
+    virtual const char* name() const = 0;
+
+    // initialize the outputs, return false if failed
+    virtual bool setup() = 0;
+
+    // power off all layers, disable all decoders
+    virtual void reset() = 0;
+
+    // a frame was published by LedCube::update()
+    //   called on the thread of the effects
+    //   changedLayers: bit z set if layer z (or its brightness)
+    //                  changed since the last call
+    virtual void present(const Frame& frame, uint8_t changedLayers) {}
+
+    // need the background thread to scan the cube ?
+    virtual bool needScan() const { return true; }
+
+    virtual void powerLayer(int z, bool on) {}
+    virtual void lightOn(int decoder, int code) {}
+    virtual void lightOff(int decoder) {}
+};
+
+
+/**********************************************************
+ *   Create a backend by name
+ *     wiringpi          : 74HC154 through wiringPi
+ *     gpiomem           : 74HC154 through /dev/gpiomem registers
+ *     sim[:dump_file]   : in-process simulator
+ *   return nullptr if unknown (or not built in)
+**********************************************************/
+CubeBackend* createBackend(const std::string& name);
+const char* defaultBackendName();
+
@@ -0,0 +1,28 @@
+#include "./gpio_mem.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+enum { MapSize = 4096 };
+
+
+GpioMem::~GpioMem() {
+    if (map_)
+        munmap(map_, MapSize);
+}
+
+bool GpioMem::open(const char* device) {
+    int fd = ::open(device, O_RDWR | O_SYNC);
+    if (fd < 0)
+        return false;
+
+    void* map = mmap(nullptr, MapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return false;
+
+    map_ = map;
+    regs_ = static_cast<volatile uint32_t*>(map);
+    return true;
+}
+
@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+
+
+/***********************************************************
+ *   GpioMem
+ *     BCM283x / BCM2711 GPIO registers, accessed directly
+ *     through a memory mapped block (/dev/gpiomem)
+ *
+ *   Only bank 0 (GPIO 0 ~ 31) is supported, which covers
+ *   all the pins of the 40-pin header.
+***********************************************************/
+class GpioMem {
+public:
+    // register offsets (in 32-bit words)
+    enum {
+        GPFSEL0 = 0,      // function select, 3 bits per pin, 6 registers
+        GPSET0  = 7,      // write 1 to set the pin
+        GPCLR0  = 10,     // write 1 to clear the pin
+        GPLEV0  = 13,     // pin level
+        RegisterCount = 45
+    };
+
+    enum { FunctionInput = 0, FunctionOutput = 1 };
+
+    GpioMem() {}
+    ~GpioMem();
+
+    // map /dev/gpiomem, return false if failed
+    bool open(const char* device = "/dev/gpiomem");
+
+    // use another register block instead (see MockGpioRegisters)
+    void attach(volatile uint32_t* registers) { regs_ = registers; }
+
+    bool isOpen() const { return regs_ != nullptr; }
+
+    void setFunction(int pin, int function) {
+        volatile uint32_t& fsel = regs_[GPFSEL0 + pin / 10];
+        int shift = (pin % 10) * 3;
+        fsel = (fsel & ~(7u << shift)) | (uint32_t(function) << shift);
+    }
+
+    // one register write each, for any number of pins
+    void set(uint32_t bits) { regs_[GPSET0] = bits; }
+    void clear(uint32_t bits) { regs_[GPCLR0] = bits; }
+
+    uint32_t levels() const { return regs_[GPLEV0]; }
+
+private:
+    volatile uint32_t* regs_ = nullptr;
+    void* map_ = nullptr;   // owned mapping (open() only)
+};
+
+
+/***********************************************************
+ *   MockGpioRegisters
+ *     an in-memory register file with the same layout,
+ *     for testing GpioMem users without /dev/gpiomem
+ *
+ *   Writes land in GPSET0 / GPCLR0 like on the real chip.
+ *   sync() applies them to GPLEV0 (and reset them to 0).
+***********************************************************/
+class MockGpioRegisters {
+public:
+    MockGpioRegisters() {
+        for (int i = 0; i < GpioMem::RegisterCount; ++i)
+            regs_[i] = 0;
+    }
+
+    volatile uint32_t* base() { return regs_; }
+
+    // pending writes since the last sync()
+    uint32_t pendingSet() const { return regs_[GpioMem::GPSET0]; }
+    uint32_t pendingClear() const { return regs_[GpioMem::GPCLR0]; }
+
+    void sync() {
+        uint32_t level = regs_[GpioMem::GPLEV0];
+        level |= regs_[GpioMem::GPSET0];
+        level &= ~regs_[GpioMem::GPCLR0];
+        regs_[GpioMem::GPLEV0] = level;
+        regs_[GpioMem::GPSET0] = 0;
+        regs_[GpioMem::GPCLR0] = 0;
+    }
+
+    bool level(int pin) const {
+        return (regs_[GpioMem::GPLEV0] >> pin) & 1;
+    }
+
+    int function(int pin) const {
+        return (regs_[GpioMem::GPFSEL0 + pin / 10] >> ((pin % 10) * 3)) & 7;
+    }
+
+private:
+    volatile uint32_t regs_[GpioMem::RegisterCount];
+};
+
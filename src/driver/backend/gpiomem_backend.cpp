@@ -0,0 +1,81 @@
+#include "./gpiomem_backend.h"
+#include <cstdio>
+
+
+GpioMemBackend::GpioMemBackend(const CubePins& pins, volatile uint32_t* registers) :
+    pins_(pins), registers_(registers)
+{
+}
+
+bool GpioMemBackend::setup() {
+    // only bank 0 of the GPIO registers
+    const int* addressPins[] = { &pins_.a, &pins_.b, &pins_.c, &pins_.d };
+    for (auto pin : addressPins) {
+        if (*pin < 0 || *pin > 31)
+            return false;
+    }
+    for (int i = 0; i < 4; ++i) {
+        if (pins_.g[i] < 0 || pins_.g[i] > 31)
+            return false;
+    }
+    for (int z = 0; z < 8; ++z) {
+        if (pins_.vcc[z] < 0 || pins_.vcc[z] > 31)
+            return false;
+    }
+
+    if (registers_) {
+        gpio_.attach(registers_);
+    }
+    else if (!gpio_.open()) {
+        printf("Can't map /dev/gpiomem\n");
+        return false;
+    }
+
+    // 74hc154: output code ==> D C B A
+    uint32_t addressBits = (1u << pins_.a) | (1u << pins_.b) | (1u << pins_.c) | (1u << pins_.d);
+    for (int code = 0; code < 16; ++code) {
+        uint32_t bits = 0;
+        if (code & 0x01) bits |= 1u << pins_.a;
+        if (code & 0x02) bits |= 1u << pins_.b;
+        if (code & 0x04) bits |= 1u << pins_.c;
+        if (code & 0x08) bits |= 1u << pins_.d;
+        setBits_[code] = bits;
+        for (int i = 0; i < 4; ++i) {
+            clearBits_[i][code] = (addressBits & ~bits) | (1u << pins_.g[i]);
+        }
+    }
+
+    for (int i = 0; i < 4; ++i) {
+        enableBits_[i] = 1u << pins_.g[i];
+        allEnableBits_ |= enableBits_[i];
+    }
+    for (int z = 0; z < 8; ++z) {
+        vccBits_[z] = 1u << pins_.vcc[z];
+        allVccBits_ |= vccBits_[z];
+    }
+
+    // disable the decoders before switching the pins to output
+    gpio_.set(allEnableBits_);
+    gpio_.clear(addressBits | allVccBits_);
+
+    gpio_.setFunction(pins_.a, GpioMem::FunctionOutput);
+    gpio_.setFunction(pins_.b, GpioMem::FunctionOutput);
+    gpio_.setFunction(pins_.c, GpioMem::FunctionOutput);
+    gpio_.setFunction(pins_.d, GpioMem::FunctionOutput);
+    for (int i = 0; i < 4; ++i) {
+        gpio_.setFunction(pins_.g[i], GpioMem::FunctionOutput);
+    }
+    for (int z = 0; z < 8; ++z) {
+        gpio_.setFunction(pins_.vcc[z], GpioMem::FunctionOutput);
+    }
+
+    return true;
+}
+
+void GpioMemBackend::reset() {
+    // set G of all the 74hc154 to HIGH (all the outputs are HIGH)
+    gpio_.set(allEnableBits_);
+    // set all VCC to LOW
+    gpio_.clear(allVccBits_);
+}
+
@@ -0,0 +1,56 @@
+#pragma once
+#include "./backend.h"
+#include "./gpio_mem.h"
+
+
+/*************************************************************
+ *   GpioMemBackend
+ *     drive the 74HC154s by writing the GPIO set / clear
+ *     registers directly (no wiringPi, no digitalWrite)
+ *
+ *   lightOn():  2 writes  (address 1-bits, then address
+ *                          0-bits + enable in the same write)
+ *   lightOff(): 1 write
+ *
+ *   Pass a register block (MockGpioRegisters::base()) to
+ *   run without /dev/gpiomem.
+*************************************************************/
+class GpioMemBackend : public CubeBackend {
+public:
+    GpioMemBackend(const CubePins& pins = CubePins(), volatile uint32_t* registers = nullptr);
+
+    virtual const char* name() const { return "gpiomem"; }
+
+    virtual bool setup();
+    virtual void reset();
+
+    virtual void powerLayer(int z, bool on) {
+        if (on)
+            gpio_.set(vccBits_[z]);
+        else
+            gpio_.clear(vccBits_[z]);
+    }
+
+    virtual void lightOn(int decoder, int code) {
+        if (setBits_[code])
+            gpio_.set(setBits_[code]);
+        gpio_.clear(clearBits_[decoder][code]);
+    }
+
+    virtual void lightOff(int decoder) {
+        gpio_.set(enableBits_[decoder]);
+    }
+
+private:
+    CubePins pins_;
+    volatile uint32_t* registers_;
+    GpioMem gpio_;
+
+    uint32_t vccBits_[8];
+    uint32_t enableBits_[4];
+    uint32_t allVccBits_ = 0;
+    uint32_t allEnableBits_ = 0;
+    uint32_t setBits_[16];          // address pins to set for an output code
+    uint32_t clearBits_[4][16];     // address pins to clear + enable (G low)
+};
+
@@ -0,0 +1,76 @@
+#include "./simulator_backend.h"
+#include <cstdio>
+#include <cinttypes>
+#include <time.h>
+
+
+SimulatorBackend::SimulatorBackend(const std::string& dumpFile, size_t capacity) :
+    dumpFile_(dumpFile), capacity_(capacity)
+{
+    records_.reserve(capacity_);
+}
+
+SimulatorBackend::~SimulatorBackend() {
+    if (!dumpFile_.empty()) {
+        if (save(dumpFile_))
+            printf("Simulator: %zu frames saved to %s\n", recordCount(), dumpFile_.c_str());
+        else
+            printf("Simulator: can't write %s\n", dumpFile_.c_str());
+    }
+}
+
+void SimulatorBackend::present(const Frame& frame, uint8_t changedLayers) {
+    // nothing new, the last record still holds
+    if (!changedLayers)
+        return;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (records_.size() < capacity_) {
+        records_.push_back({ uint64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec, frame });
+    }
+    else {
+        ++dropped_;
+    }
+}
+
+std::vector<SimulatorBackend::Record> SimulatorBackend::records() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return records_;
+}
+
+size_t SimulatorBackend::recordCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return records_.size();
+}
+
+size_t SimulatorBackend::droppedCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+}
+
+void SimulatorBackend::clearRecords() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    records_.clear();
+    dropped_ = 0;
+}
+
+bool SimulatorBackend::save(const std::string& filename) const {
+    FILE* fp = fopen(filename.c_str(), "w");
+    if (!fp)
+        return false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& record : records_) {
+        fprintf(fp, "%" PRIu64, record.timeNs);
+        for (int z = 0; z < 8; ++z) {
+            fprintf(fp, " %016" PRIx64, record.frame.layers[z]);
+        }
+        fprintf(fp, "\n");
+    }
+    fclose(fp);
+    return true;
+}
+
@@ -0,0 +1,55 @@
+#pragma once
+#include "./backend.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+/*********************************************************
+ *   SimulatorBackend
+ *     headless, in-process
+ *     records every changed frame with its timestamp
+ *     so effects can be run, profiled and regression-tested
+ *     on any Linux machine
+ *
+ *   If a dump file is given, the recorded frames are saved
+ *   to it (text, one frame per line) when destroyed:
+ *     <time_ns> <layer0> <layer1> ... <layer7>
+*********************************************************/
+class SimulatorBackend : public CubeBackend {
+public:
+    struct Record {
+        uint64_t timeNs;    // CLOCK_MONOTONIC
+        Frame frame;
+    };
+
+    enum { DefaultCapacity = 1 << 16 };
+
+    SimulatorBackend(const std::string& dumpFile = "", size_t capacity = DefaultCapacity);
+    virtual ~SimulatorBackend();
+
+    virtual const char* name() const { return "sim"; }
+
+    virtual bool setup() { return true; }
+    virtual void reset() {}
+    virtual void present(const Frame& frame, uint8_t changedLayers);
+    virtual bool needScan() const { return false; }
+
+    // copy of the recorded frames (thread safe)
+    std::vector<Record> records() const;
+    size_t recordCount() const;
+    // frames not recorded because the capacity was reached
+    size_t droppedCount() const;
+    void clearRecords();
+
+    bool save(const std::string& filename) const;
+
+private:
+    std::string dumpFile_;
+    size_t capacity_;
+    size_t dropped_ = 0;
+    std::vector<Record> records_;
+    mutable std::mutex mutex_;
+};
+
@@ -0,0 +1,53 @@
+#ifdef LEDCUBE_WITH_WIRINGPI
+
+#include "./wiringpi_backend.h"
+#include <cstdio>
+#include <wiringPi.h>
+
+
+bool WiringPiBackend::setup() {
+    if (wiringPiSetupGpio() == -1) {
+        printf("Wiringpi setup failed\n");
+        return false;
+    }
+
+    for (int i = 0; i < 4; ++i) {
+        x74hc154[i].setup(pins_.a, pins_.b, pins_.c, pins_.d, pins_.g[i]);
+    }
+
+    for (int i = 0; i < 8; ++i) {
+        pinMode(pins_.vcc[i], OUTPUT);
+    }
+
+    return true;
+}
+
+void WiringPiBackend::reset() {
+    // 74hc154
+    // set G1 or G2 to HIGH
+    // so all the outputs are HIGH
+    for (int i = 0; i < 4; ++i) {
+        x74hc154[i].enable(false);
+    }
+
+    // VCC
+    // set all VCC to LOW
+    for (int i = 0; i < 8; ++i) {
+        digitalWrite(pins_.vcc[i], LOW);
+    }
+}
+
+void WiringPiBackend::powerLayer(int z, bool on) {
+    digitalWrite(pins_.vcc[z], on ? HIGH : LOW);
+}
+
+void WiringPiBackend::lightOn(int decoder, int code) {
+    x74hc154[decoder].setOutput(code);
+    x74hc154[decoder].enable(true);
+}
+
+void WiringPiBackend::lightOff(int decoder) {
+    x74hc154[decoder].enable(false);
+}
+
+#endif // LEDCUBE_WITH_WIRINGPI
@@ -0,0 +1,28 @@
+#pragma once
+#include "./backend.h"
+#include "../x_74hc154.h"
+
+
+/*****************************************************
+ *   WiringPiBackend
+ *     drive the cube with 4 x 74HC154 through wiringPi
+ *     (Raspberry Pi only)
+*****************************************************/
+class WiringPiBackend : public CubeBackend {
+public:
+    WiringPiBackend(const CubePins& pins = CubePins()) : pins_(pins) {}
+
+    virtual const char* name() const { return "wiringpi"; }
+
+    virtual bool setup();
+    virtual void reset();
+
+    virtual void powerLayer(int z, bool on);
+    virtual void lightOn(int decoder, int code);
+    virtual void lightOff(int decoder);
+
+private:
+    CubePins pins_;
+    X74hc154 x74hc154[4];
+};
+
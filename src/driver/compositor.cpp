@@ -0,0 +1,60 @@
+#include "./compositor.h"
+#include "./cube.h"
+
+extern LedCube cube;
+
+
+int Compositor::addLayer(BlendMode mode) {
+    if (count_ >= MaxLayers)
+        return -1;
+    Layer& layer = layers_[count_];
+    layer.leds.clear();
+    layer.mask = ~layer.leds;
+    layer.mode = mode;
+    layer.visible = true;
+    return count_++;
+}
+
+void Compositor::clear() {
+    for (int i = 0; i < count_; ++i)
+        layers_[i].leds.clear();
+}
+
+void Compositor::beginLayer(int id) {
+    if (drawing_ >= 0)
+        endLayer();
+    saved_ = cube.getLeds();
+    cube.setLeds(layers_[id].leds);
+    drawing_ = id;
+}
+
+void Compositor::endLayer() {
+    if (drawing_ < 0)
+        return;
+    layers_[drawing_].leds = cube.getLeds();
+    cube.setLeds(saved_);
+    drawing_ = -1;
+}
+
+Frame Compositor::compose() const {
+    Frame result;
+    result.clear();
+    for (int i = 0; i < count_; ++i) {
+        const Layer& layer = layers_[i];
+        if (!layer.visible)
+            continue;
+        switch (layer.mode) {
+        case BLEND_OR:   result |= layer.leds; break;
+        case BLEND_XOR:  result ^= layer.leds; break;
+        case BLEND_OVER: result.blend(layer.mask, layer.leds); break;
+        default: break;
+        }
+    }
+    return result;
+}
+
+void Compositor::render() const {
+    cube.setLeds(compose());
+    LedCube::update();
+}
+
@@ -0,0 +1,73 @@
+#pragma once
+#include "../utility/enum.h"
+#include "../utility/frame.h"
+
+
+/*************************************************************
+ *   Compositor
+ *     several layers, each animated on its own in its own
+ *     Frame, blended into the cube once per tick
+ *
+ *   Layers are blended bottom first, in the order they were
+ *   added (the last one has the highest priority):
+ *     BLEND_OR:   lit if lit in the layer or below
+ *     BLEND_XOR:  the lit LEDs of the layer toggle the ones
+ *                 below
+ *     BLEND_OVER: the layer replaces the LEDs below where its
+ *                 mask is set (all the cube by default)
+ *
+ *   The drawing functions of LedCube can draw in a layer:
+ *     compositor.beginLayer(snake);
+ *     cube.lightLine(...);        // in the layer, not the cube
+ *     compositor.endLayer();
+ *     compositor.render();        // the cube shows all layers
+*************************************************************/
+class Compositor {
+public:
+    enum { MaxLayers = 8 };
+
+    // a new (empty, visible) layer on top, -1 if there are
+    // already MaxLayers
+    int addLayer(BlendMode mode = BLEND_OR);
+    int layerCount() const { return count_; }
+
+    Frame& layer(int id) { return layers_[id].leds; }
+    const Frame& layer(int id) const { return layers_[id].leds; }
+
+    void setMode(int id, BlendMode mode) { layers_[id].mode = mode; }
+    void setMask(int id, const Frame& mask) { layers_[id].mask = mask; }
+    void setVisible(int id, bool visible) { layers_[id].visible = visible; }
+
+    // every layer off (modes and masks are kept)
+    void clear();
+
+    /*********************************************
+     *  Draw in a layer with LedCube
+     *    begin: the layer takes the place of the
+     *           LEDs state buffer of the cube
+     *    end:   back to the cube (one at a time)
+    *********************************************/
+    void beginLayer(int id);
+    void endLayer();
+
+    // the layers blended, bottom first
+    Frame compose() const;
+    // compose() into the cube and update() it
+    // (the brightness levels are not changed)
+    void render() const;
+
+private:
+    struct Layer {
+        Frame leds;
+        Frame mask;         // BLEND_OVER
+        BlendMode mode;
+        bool visible;
+    };
+
+    Layer layers_[MaxLayers];
+    int count_ = 0;
+
+    int drawing_ = -1;      // beginLayer()
+    Frame saved_;           // the LEDs of the cube meanwhile
+};
+
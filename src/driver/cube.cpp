@@ -1,95 +1,245 @@
 #include "./cube.h"
+#include "./refresh_stats.h"
+#include "../utility/frame_mask.h"
 #include "../utility/image_lib.h"
+#include "../utility/line_cache.h"
 #include "../utility/utils.h"
+#include "../utility/delay.h"
 #include <cstring>
+#include <cerrno>
 #include <thread>
 #include <chrono>
 #include <vector>
 #include <iostream>
-#include <wiringPi.h>
-
-LedState LedCube::leds[8][8][8];  // Z X Y
-LedState LedCube::ledsBuff[8][8][8];  // Z X Y
-int LedCube::vcc[8];
-X74hc154 LedCube::x74hc154[4];
-bool LedCube::isRunning = true;
-bool LedCube::isBackgroundThreadQuit = true;
-std::mutex LedCube::mutex_;
+#include <pthread.h>
+#include <signal.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <time.h>
+
+TripleBuffer<ScanPlan> LedCube::scanPlans;
+Frame LedCube::ledsBuff;
+uint64_t LedCube::levelsBuff[8][LevelBits];
+Frame LedCube::publishedLeds;
+uint64_t LedCube::publishedLevels[8][LevelBits];
+uint32_t LedCube::layerVersions[8];
+uint32_t LedCube::version = 0;
+CubeBackend* LedCube::backend_ = nullptr;
+AnimationWriter* LedCube::recorder = nullptr;
+FrameStream* LedCube::capture = nullptr;
+uint64_t LedCube::captureUs = 0;
+uint64_t LedCube::deadlineNs = 0;
+std::thread LedCube::refreshThread;
+std::atomic<bool> LedCube::isRunning(false);
+std::atomic<bool> LedCube::stopRequested(false);
+void (*LedCube::stopHandler)() = nullptr;
 bool LedCube::setuped = false;
-int LedCube::loopCount = LedCube::DefaultLoopCount;
+std::atomic<int> LedCube::dwellNs(LedCube::DefaultDwellNs);
 
 
-LedCube::~LedCube() {
-    quit();
+// Bit i of a byte ==> bit (i * 8), i.e. column 0 of a layer
+static inline uint64_t spreadToColumn(uint8_t byte) {
+    uint64_t bits = byte;
+    bits = (bits | (bits << 28)) & 0x0000000F0000000FULL;
+    bits = (bits | (bits << 14)) & 0x0003000300030003ULL;
+    bits = (bits | (bits << 7))  & 0x0101010101010101ULL;
+    return bits;
 }
 
-void LedCube::setup() {
-    x74hc154[0].setup(17, 27, 22, 5, 6);
-    x74hc154[1].setup(17, 27, 22, 5, 13);
-    x74hc154[2].setup(17, 27, 22, 5, 19);
-    x74hc154[3].setup(17, 27, 22, 5, 26);
+// CLOCK_MONOTONIC (clock_nanosleep() doesn't take CLOCK_MONOTONIC_RAW)
+static uint64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
 
-    vcc[0] = 18;  vcc[1] = 23;
-    vcc[2] = 24;  vcc[3] = 25;
-    vcc[4] = 12;  vcc[5] = 16;
-    vcc[6] = 20;  vcc[7] = 21;
+// Apply the options to the calling thread (warn only)
+static void applyRefreshOptions(const RefreshOptions& options) {
+    if (options.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(options.cpu, &set);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err != 0)
+            printf("Pin refresh thread to cpu %d failed: %s\n", options.cpu, strerror(err));
+    }
 
-    for (int i = 0; i < 8; ++i) {
-        pinMode(vcc[i], OUTPUT);
+    if (options.priority > 0) {
+        sched_param param;
+        param.sched_priority = options.priority;
+        int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (err != 0)
+            printf("Set SCHED_FIFO priority %d failed: %s\n", options.priority, strerror(err));
+    }
+}
+
+static inline void applyBits(uint64_t& layer, uint64_t bits, LedState state) {
+    if (state == LED_ON)
+        layer |= bits;
+    else
+        layer &= ~bits;
+}
+
+
+LedCube::~LedCube() {
+    quit();
+}
+
+bool LedCube::setup(CubeBackend* backend, const RefreshOptions& options) {
+    backend_ = backend;
+    if (!backend_->setup()) {
+        delete backend_;
+        backend_ = nullptr;
+        return false;
     }
 
+    RefreshStats::reset();
+    GlyphCache::warmUp();
     reset();
 
-    std::thread t(backgroundThread);
-    t.detach();
+    if (backend_->needScan()) {
+        // lock the pages now, the scanner must never wait for a page fault
+        if (options.lockMemory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+            printf("mlockall failed: %s\n", strerror(errno));
+
+        util::SpinDelay::calibrate();
+        isRunning = true;
+
+        // the signals (Ctrl+C, SIGUSR1) go to the thread of the
+        // effects, never to the refresh thread (it would join itself)
+        sigset_t blocked, saved;
+        sigemptyset(&blocked);
+        sigaddset(&blocked, SIGINT);
+        sigaddset(&blocked, SIGUSR1);
+        pthread_sigmask(SIG_BLOCK, &blocked, &saved);
+        refreshThread = std::thread(backgroundThread, options);
+        pthread_sigmask(SIG_SETMASK, &saved, nullptr);
+    }
 
     setuped = true;
+    return true;
 }
 
 void LedCube::quit() {
     if (setuped) {
         isRunning = false;
-        int count = 5;
-        while (!isBackgroundThreadQuit && count-- > 0) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        }
+        if (refreshThread.joinable())
+            refreshThread.join();
         reset();
+        setuped = false;
+        delete backend_;
+        backend_ = nullptr;
     }
 }
 
 void LedCube::update() {
-    mutex_.lock();
-    memcpy(leds, ledsBuff, 512);
-    mutex_.unlock();
+    if (capture) {
+        capture->append(ledsBuff, levelsBuff);
+        return;
+    }
+
+    uint64_t start = util::SpinDelay::nowNs();
+
+    // find the changed layers
+    uint8_t changed = 0;
+    ++version;
+    for (int z = 0; z < 8; ++z) {
+        if (ledsBuff.layers[z] != publishedLeds.layers[z] ||
+            memcmp(levelsBuff[z], publishedLevels[z], sizeof(levelsBuff[z])) != 0)
+        {
+            changed |= 1 << z;
+            layerVersions[z] = version;
+            publishedLeds.layers[z] = ledsBuff.layers[z];
+            memcpy(publishedLevels[z], levelsBuff[z], sizeof(levelsBuff[z]));
+        }
+    }
+
+    // the back plan may be several versions old, it catches up
+    // on all the layers changed since it was compiled
+    scanPlans.back().compile(ledsBuff, levelsBuff, layerVersions);
+    scanPlans.publish();
+    if (backend_)
+        backend_->present(ledsBuff, changed);
+    if (recorder)
+        recorder->record(ledsBuff, levelsBuff, monotonicNs());
+    RefreshStats::recordPublish(start, util::SpinDelay::nowNs());
+
+    if (RefreshStats::takeDumpRequest())
+        RefreshStats::dump(stdout);
+    pollStop();
 }
 
+void LedCube::pollStop() {
+    if (stopRequested.load(std::memory_order_relaxed) &&
+        stopRequested.exchange(false, std::memory_order_relaxed) && stopHandler)
+        stopHandler();
+}
 
-void LedCube::reset() {
-    // 74hc154
-    // set G1 or G2 to HIGH
-    // so all the outputs are HIGH
-    for (int i = 0; i < 4; ++i) {
-        x74hc154[i].enable(false);
+
+void LedCube::setFrame(const Frame& leds, const uint64_t levels[8][LevelBits]) {
+    ledsBuff = leds;
+    memcpy(levelsBuff, levels, sizeof(levelsBuff));
+}
+
+
+/****************************************
+ *
+ *   Time of the effects
+ *
+** *************************************/
+void LedCube::sleepUs(uint64_t us) {
+    if (capture) {
+        // nothing captured yet: the frame on the cube stays
+        if (capture->empty())
+            capture->append(publishedLeds, publishedLevels);
+        capture->extend(uint32_t(us));
+        captureUs += us;
+        return;
     }
 
-    // VCC
-    // set all VCC to LOW
-    for (int i = 0; i < 8; ++i) {
-        digitalWrite(vcc[i], LOW);
+    // far behind (the first sleep, or the effect was blocked):
+    // start a new timeline instead of catching up in a burst
+    uint64_t now = monotonicNs();
+    if (deadlineNs + MaxLagNs < now)
+        deadlineNs = now;
+    deadlineNs += us * 1000;
+
+    struct timespec ts;
+    ts.tv_sec = deadlineNs / 1000000000;
+    ts.tv_nsec = deadlineNs % 1000000000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+        //;
     }
+    pollStop();
+}
+
+uint64_t LedCube::nowUs() {
+    if (capture)
+        return captureUs;
+    return monotonicNs() / 1000;
+}
+
+void LedCube::beginCapture(FrameStream* stream) {
+    capture = stream;
+    captureUs = 0;
+}
+
+void LedCube::endCapture() {
+    capture = nullptr;
+}
+
+
+void LedCube::reset() {
+    // power off all the layers, disable all the decoders
+    if (backend_)
+        backend_->reset();
 
     // light off all the LEDs
-    for (int z = 0; z < 8; ++z) {
-        for (int x = 0; x < 8; ++x) {
-            for (int y = 0; y < 8; ++y) {
-                leds[z][x][y] = LED_OFF;
-                ledsBuff[z][x][y] = LED_OFF;
-            }
-        }
-    }
+    clear();
+    update();
 
-    // set loopCount to default (not zero, see the function)
-    setLoopCount(0);
+    // set dwell time to default
+    setDwellNs(0);
 }
 
 
@@ -100,42 +250,48 @@ void LedCube::reset() {
  *      light on or light off
  *
 ** *************************************/
-void LedCube::backgroundThread() {
-    isBackgroundThreadQuit = false;
-    while (isRunning) {
-        mutex_.lock();
-        for (int z = 0; z < 8; ++z) {
-            for (int x = 0; x < 8; ++x) {
-                int idx = x / 2;
+void LedCube::backgroundThread(RefreshOptions options) {
+    applyRefreshOptions(options);
+
+    while (isRunning.load(std::memory_order_relaxed)) {
+        uint64_t passStart = util::SpinDelay::nowNs();
+        // pick up the newest complete frame (if any)
+        scanPlans.acquire();
+        const ScanPlan& plan = scanPlans.front();
+        for (int p = 0; p < plan.planeCount; ++p) {
+            const ScanPlan::Plane& plane = plan.planes[p];
+            // light each LED for weight/15 of the dwell time
+            uint32_t dwell = dwellNs.load(std::memory_order_relaxed) * plane.weight / MaxLevel;
+            for (int z = 0; z < 8; ++z) {
+                const ScanPlan::Entry* begin = plan.begin(p, z);
+                const ScanPlan::Entry* end = plan.end(p, z);
+                if (begin == end)
+                    continue;
                 // power on the layer z
-                digitalWrite(vcc[z], HIGH);
-                for (int y = 0; y < 8; ++y) {
-                    if (leds[z][x][y] == LED_ON) {
-                        x74hc154[idx].setOutput(y + 8 * (x % 2));
-                        x74hc154[idx].enable(true);
-                        // slepp serveral nanoseconds
-                        // shouldn't use:
-                        //   std::this_thread::sleep_for(std::chrono::nanoseconds(100));
-                        //   even if you want to sleep 1 ns, it will consume 10000+ ns really
-                        for (int i = 0; i < loopCount; ++i) {
-                            //;
-                        }
-                        x74hc154[idx].enable(false);
-                    }
+                backend_->powerLayer(z, true);
+                for (const ScanPlan::Entry* entry = begin; entry != end; ++entry) {
+                    backend_->lightOn(entry->decoder, entry->code);
+                    // slepp serveral nanoseconds
+                    // shouldn't use:
+                    //   std::this_thread::sleep_for(std::chrono::nanoseconds(100));
+                    //   even if you want to sleep 1 ns, it will consume 10000+ ns really
+                    util::SpinDelay::spinNs(dwell);
+                    backend_->lightOff(entry->decoder);
                 }
                 // power off the layer z
-                digitalWrite(vcc[z], LOW);
+                backend_->powerLayer(z, false);
             }
+            // the dimmed LEDs stay dark as long as they would be lit,
+            // so the refresh frequence doesn't depend on the levels
+            if (plane.idle)
+                util::SpinDelay::spinNs(dwell * plane.idle);
         }
-        mutex_.unlock();
+        RefreshStats::recordPass(util::SpinDelay::nowNs() - passStart);
+
         // delay some time
-        //   slepp serveral nanoseconds
-        for (int i = 0; i < 5000; ++i) {
-            //;
-        }
+        util::SpinDelay::spinNs(FrameGapNs);
     }
 
-    isBackgroundThreadQuit = true;
     printf("Background thread quit!\n");
 }
 
@@ -146,7 +302,22 @@ void LedCube::backgroundThread() {
  *
 ** **********************************/
 void LedCube::clear() {
-    memset(ledsBuff, LED_OFF, 512);
+    ledsBuff.clear();
+    setLevel(MaxLevel);
+}
+
+
+/************************************
+ *
+ *   Set the brightness of all leds
+ *
+** **********************************/
+void LedCube::setLevel(int level) {
+    for (int z = 0; z < 8; ++z) {
+        for (int b = 0; b < LevelBits; ++b) {
+            levelsBuff[z][b] = (level & (1 << b)) ? ~uint64_t(0) : 0;
+        }
+    }
 }
 
 
@@ -156,68 +327,78 @@ void LedCube::clear() {
  *
 **************************************************/
 void LedCube::lightLayerZ(int z, LedState state) {
-    for (int x = 0; x < 8; ++x) {
-        for (int y = 0; y < 8; ++y) {
-            ledsBuff[z][x][y] = state;
-        }
-    }
+    ledsBuff.layers[z] = (state == LED_ON) ? ~uint64_t(0) : 0;
 }
 
 void LedCube::lightLayerY(int y, LedState state) {
-    for (int z = 0; z < 8; ++z) {
-        for (int x = 0; x < 8; ++x) {
-            ledsBuff[z][x][y] = state;
-        }
-    }
+    lightMask(FrameMask::planeY(y), state);
 }
 
 void LedCube::lightLayerX(int x, LedState state) {
-    for (int z = 0; z < 8; ++z) {
-        for (int y = 0; y < 8; ++y) {
-            ledsBuff[z][x][y] = state;
-        }
-    }
+    lightMask(FrameMask::planeX(x), state);
 }
 
 void LedCube::lightLayerZ(int z, int imageCode, Direction viewDirection, Angle rotate) {
-    Array2D_8_8 image;
-    getImageInLayerZ(image, imageCode, viewDirection, rotate);
-    lightLayerZ(z, image);
+    lightLayerZ(z, getImageInLayerZ(imageCode, viewDirection, rotate));
 }
 
 void LedCube::lightLayerY(int y, int imageCode, Direction viewDirection, Angle rotate) {
-    Array2D_8_8 image;
-    getImageInLayerY(image, imageCode, viewDirection, rotate);
-    lightLayerY(y, image);
+    lightLayerY(y, getImageInLayerY(imageCode, viewDirection, rotate));
 }
 
 void LedCube::lightLayerX(int x, int imageCode, Direction viewDirection, Angle rotate) {
-    Array2D_8_8 image;
-    getImageInLayerX(image, imageCode, viewDirection, rotate);
-    lightLayerX(x, image);
+    lightLayerX(x, getImageInLayerX(imageCode, viewDirection, rotate));
+}
+
+// image[x][y], already the layout of a layer
+void LedCube::lightLayerZ(int z, Glyph image) {
+    ledsBuff.layers[z] = image.bits;
+}
+
+// image[z][x], row z spread over column y
+void LedCube::lightLayerY(int y, Glyph image) {
+    for (int z = 0; z < 8; ++z) {
+        ledsBuff.layers[z] = (ledsBuff.layers[z] & ~FrameMask::colBits(y)) | (spreadToColumn(image.row(z)) << y);
+    }
+}
+
+// image[z][y], row z is row x of layer z
+void LedCube::lightLayerX(int x, Glyph image) {
+    for (int z = 0; z < 8; ++z) {
+        ledsBuff.layers[z] = (ledsBuff.layers[z] & ~FrameMask::rowBits(x)) | (uint64_t(image.row(z)) << (x * 8));
+    }
 }
 
 void LedCube::lightLayerZ(int z, const Array2D_8_8& image) {
+    uint64_t layer = 0;
     for (int x = 0; x < 8; ++x) {
         for (int y = 0; y < 8; ++y) {
-            ledsBuff[z][x][y] = image[x][y];
+            if (image[x][y] == LED_ON)
+                layer |= Frame::mask(x, y);
         }
     }
+    ledsBuff.layers[z] = layer;
 }
 
 void LedCube::lightLayerY(int y, const Array2D_8_8& image) {
     for (int z = 0; z < 8; ++z) {
+        uint64_t bits = 0;
         for (int x = 0; x < 8; ++x) {
-            ledsBuff[z][x][y] = image[z][x];
+            if (image[z][x] == LED_ON)
+                bits |= Frame::mask(x, y);
         }
+        ledsBuff.layers[z] = (ledsBuff.layers[z] & ~FrameMask::colBits(y)) | bits;
     }
 }
 
 void LedCube::lightLayerX(int x, const Array2D_8_8& image) {
     for (int z = 0; z < 8; ++z) {
+        uint64_t bits = 0;
         for (int y = 0; y < 8; ++y) {
-            ledsBuff[z][x][y] = image[z][y];
+            if (image[z][y] == LED_ON)
+                bits |= Frame::mask(x, y);
         }
+        ledsBuff.layers[z] = (ledsBuff.layers[z] & ~FrameMask::rowBits(x)) | bits;
     }
 }
 
@@ -230,59 +411,71 @@ void LedCube::lightLayerX(int x, const Array2D_8_8& image) {
 ***************************************************/
 // the same state
 void LedCube::lightRowXY(int x, int y, LedState state) {
-    for (int z = 0; z < 8; ++z) {
-        ledsBuff[z][x][y] = state;
-    }
+    lightMask(FrameMask::box({ x, y, 0 }, { x, y, 7 }), state);
 }
 
 void LedCube::lightRowYZ(int y, int z, LedState state)  {
-    for (int x = 0; x < 8; ++x) {
-        ledsBuff[z][x][y] = state;
-    }
+    applyBits(ledsBuff.layers[z], FrameMask::colBits(y), state);
 }
 
 void LedCube::lightRowXZ(int x, int z, LedState state) {
-    for (int y = 0; y < 8; ++y) {
-        ledsBuff[z][x][y] = state;
-    }
+    applyBits(ledsBuff.layers[z], FrameMask::rowBits(x), state);
 }
 
-// the same state
+// the same state (none if start > end)
 void LedCube::lightRowXY(int x, int y, int zStart, int zEnd, LedState state) {
-    for (int z = zStart; z <= zEnd; ++z) {
-        ledsBuff[z][x][y] = state;
-    }
+    if (zStart <= zEnd)
+        lightMask(FrameMask::box({ x, y, zStart }, { x, y, zEnd }), state);
 }
 
 void LedCube::lightRowYZ(int y, int z, int xStart, int xEnd, LedState state) {
-    for (int x = xStart; x <= xEnd; ++x) {
-        ledsBuff[z][x][y] = state;
-    }
+    applyBits(ledsBuff.layers[z], FrameMask::rectBits(xStart, xEnd, y, y), state);
 }
 
 void LedCube::lightRowXZ(int x, int z, int yStart, int yEnd, LedState state) {
-    for (int y = yStart; y <= yEnd; ++y) {
-        ledsBuff[z][x][y] = state;
-    }
+    applyBits(ledsBuff.layers[z], FrameMask::rectBits(x, x, yStart, yEnd), state);
 }
 
 // different state
 void LedCube::lightRowXY(int x, int y, const std::array<LedState, 8>& state) {
     for (int z = 0; z < 8; ++z) {
-        ledsBuff[z][x][y] = state[z];
+        applyBits(ledsBuff.layers[z], Frame::mask(x, y), state[z]);
     }
 }
 
 void LedCube::lightRowYZ(int y, int z, const std::array<LedState, 8>& state) {
+    uint64_t bits = 0;
     for (int x = 0; x < 8; ++x) {
-        ledsBuff[z][x][y] = state[x];
+        if (state[x] == LED_ON)
+            bits |= Frame::mask(x, y);
     }
+    ledsBuff.layers[z] = (ledsBuff.layers[z] & ~FrameMask::colBits(y)) | bits;
 }
 
 void LedCube::lightRowXZ(int x, int z, const std::array<LedState, 8>& state) {
+    uint64_t bits = 0;
     for (int y = 0; y < 8; ++y) {
-        ledsBuff[z][x][y] = state[y];
+        if (state[y] == LED_ON)
+            bits |= Frame::mask(x, y);
     }
+    ledsBuff.layers[z] = (ledsBuff.layers[z] & ~FrameMask::rowBits(x)) | bits;
+}
+
+
+/***************************************************
+ *
+ *      Bulk drawing, see FrameMask
+ *
+***************************************************/
+void LedCube::lightMask(const Frame& mask, LedState state) {
+    if (state == LED_ON)
+        ledsBuff.fill(mask);
+    else
+        ledsBuff.erase(mask);
+}
+
+void LedCube::blendMask(const Frame& mask, const Frame& image) {
+    ledsBuff.blend(mask, image);
 }
 
 
@@ -293,11 +486,7 @@ void LedCube::lightRowXZ(int x, int z, const std::array<LedState, 8>& state) {
 ***************************************************/
 
 void LedCube::lightLine(const Coordinate& start, const Coordinate& end, LedState state) {
-    std::vector<Coordinate> line;
-    util::getLine3D(start, end, line);
-    for (auto& point : line) {
-        ledsBuff[point.z][point.x][point.y] = state;
-    }
+    lightMask(LineCache::get(start, end), state);
 }
 
 
@@ -306,240 +495,42 @@ void LedCube::lightLine(const Coordinate& start, const Coordinate& end, LedState
  *      Get Image(including text) in a layer
  *
 ***************************************************/
-void LedCube::getImageInLayerZ(Array2D_8_8& image, int imageCode, Direction viewDirection, Angle rotate) {
-    auto table = ImageLib::get(imageCode);
-
-    if (viewDirection == Z_DESCEND) {
-        switch (rotate) {
-        case ANGLE_0:
-            for (int x = 0; x < 8; ++x) {
-                for (int y = 0; y < 8; ++y) {
-                    image[x][y] = table[x][y]; 
-                }
-            }
-            break;
-        case ANGLE_90:
-            for (int y = 7; y > -1; --y) {
-                for (int x = 0; x < 8; ++x) {
-                    image[x][y] = table[7-y][x];
-                }
-            }
-            break;
-        case ANGLE_180:
-            for (int x = 7; x > -1; --x) {
-                for (int y = 7; y > -1; --y) {
-                    image[x][y] = table[7-x][7-y];
-                }
-            }
-            break;
-        case ANGLE_270:
-            for (int y = 0; y < 8; ++y) {
-                for (int x = 7; x > -1; --x) {
-                    image[x][y] = table[y][7-x];
-                }
-            }
-            break;
-        default:
-            break;
-        }
-    }
-    else if (viewDirection == Z_ASCEND) {
-        switch (rotate) {
-        case ANGLE_0:
-            for (int x = 0; x < 8; ++x) {
-                for (int y = 7; y > -1; --y) {
-                    image[x][y] = table[x][7-y]; 
-                }
-            }
-            break;
-        case ANGLE_90:
-            for (int y = 0; y < 8; ++y) {
-                for (int x = 0; x < 8; ++x) {
-                    image[x][y] = table[y][x];
-                }
-            }
-            break;
-        case ANGLE_180:
-            for (int x = 7; x > -1; --x) {
-                for (int y = 0; y < 8; ++y) {
-                    image[x][y] = table[7-x][y];
-                }
-            }
-            break;
-        case ANGLE_270:
-            for (int y = 7; y > -1; --y) {
-                for (int x = 7; x > -1; --x) {
-                    image[x][y] = table[7-y][7-x];
-                }
-            }
-            break;
-        default:
-            break;
-        }
-    }
-    else {
-        for (int x = 0; x < 8; ++x) {
-            for (int y = 0; y < 8; ++y) {
-                image[x][y] = LED_OFF;
-            }
+static void unpackGlyph(Glyph glyph, LedCube::Array2D_8_8& image) {
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 8; ++j) {
+            image[i][j] = glyph.get(i, j) ? LED_ON : LED_OFF;
         }
     }
 }
 
+Glyph LedCube::getImageInLayerZ(int imageCode, Direction viewDirection, Angle rotate, const Font* font) {
+    if (viewDirection != Z_ASCEND && viewDirection != Z_DESCEND)
+        return Glyph{ 0 };
+    return GlyphCache::get(font, imageCode, viewDirection, rotate);
+}
+
+Glyph LedCube::getImageInLayerY(int imageCode, Direction viewDirection, Angle rotate, const Font* font) {
+    if (viewDirection != Y_ASCEND && viewDirection != Y_DESCEND)
+        return Glyph{ 0 };
+    return GlyphCache::get(font, imageCode, viewDirection, rotate);
+}
+
+Glyph LedCube::getImageInLayerX(int imageCode, Direction viewDirection, Angle rotate, const Font* font) {
+    if (viewDirection != X_ASCEND && viewDirection != X_DESCEND)
+        return Glyph{ 0 };
+    return GlyphCache::get(font, imageCode, viewDirection, rotate);
+}
+
+void LedCube::getImageInLayerZ(Array2D_8_8& image, int imageCode, Direction viewDirection, Angle rotate) {
+    unpackGlyph(getImageInLayerZ(imageCode, viewDirection, rotate), image);
+}
+
 void LedCube::getImageInLayerY(Array2D_8_8& image, int imageCode, Direction viewDirection, Angle rotate) {
-    auto table = ImageLib::get(imageCode);
-
-    if (viewDirection == Y_DESCEND) {
-        switch (rotate) {
-        case ANGLE_0:
-            for (int z = 7; z > -1; --z) {
-                for (int x = 7; x > -1; --x) {
-                    image[z][x] = table[7-z][7-x];
-                }
-            }
-            break;
-        case ANGLE_90:
-            for (int x = 0; x < 8; ++x) {
-                for (int z = 7; z > -1; --z) {
-                    image[z][x] = table[x][7-z];
-                }
-            }
-            break;
-        case ANGLE_180:
-            for (int z = 0; z < 8; ++z) {
-                for (int x = 0; x < 8; ++x) {
-                    image[z][x] = table[z][x];
-                }
-            }
-            break;
-        case ANGLE_270:
-            for (int x = 7; x > -1; --x) {
-                for (int z = 0; z < 8; ++z) {
-                    image[z][x] = table[7-x][z];
-                }
-            }
-            break;
-        default:
-            break;
-        }
-    }
-    else if (viewDirection == Y_ASCEND) {
-        switch (rotate) {
-        case ANGLE_0:
-            for (int z = 7; z > -1; --z) {
-                for (int x = 0; x < 8; ++x) {
-                    image[z][x] = table[7-z][x];
-                }
-            }
-            break;
-        case ANGLE_90:
-            for (int x = 7; x > -1; --x) {
-                for (int z = 7; z > -1; --z) {
-                    image[z][x] = table[7-x][7-z];
-                }
-            }
-            break;
-        case ANGLE_180:
-            for (int z = 0; z < 8; ++z) {
-                for (int x = 7; x > -1; --x) {
-                    image[z][x] = table[z][7-x];
-                }
-            }
-            break;
-        case ANGLE_270:
-            for (int x = 0; x < 8; ++x) {
-                for (int z = 0; z < 8; ++z) {
-                    image[z][x] = table[x][z];
-                }
-            }
-            break;
-        }
-    }
-    else {
-        for (int x = 0; x < 8; ++x) {
-            for (int z = 0; z < 8; ++z) {
-                image[z][x] = LED_OFF;
-            }
-        }
-    }
+    unpackGlyph(getImageInLayerY(imageCode, viewDirection, rotate), image);
 }
 
 void LedCube::getImageInLayerX(Array2D_8_8& image, int imageCode, Direction viewDirection, Angle rotate) {
-    auto table = ImageLib::get(imageCode);
-
-    if (viewDirection == X_DESCEND) {
-        switch (rotate) {
-        case ANGLE_0:
-            for (int z = 7; z > -1; --z) {
-                for (int y = 0; y < 8; ++y) {
-                    image[z][y] = table[7-z][y];
-                }
-            }
-            break;
-        case ANGLE_90:
-            for (int y = 7; y > -1; --y) {
-                for (int z = 7; z > -1; --z) {
-                    image[z][y] = table[7-y][7-z];
-                }
-            }
-            break;
-        case ANGLE_180:
-            for (int z = 0; z < 8; ++z) {
-                for (int y = 7; y > -1; --y) {
-                    image[z][y] = table[z][7-y];
-                }
-            }
-            break;
-        case ANGLE_270:
-            for (int y = 0; y < 8; ++y) {
-                for (int z = 0; z < 8; ++z) {
-                    image[z][y] = table[y][z];
-                }
-            }
-            break;
-        default:
-            break;
-        }
-    }
-    else if (viewDirection == X_ASCEND) {
-        switch (rotate) {
-        case ANGLE_0:
-            for (int z = 7; z > -1; --z) {
-                for (int y = 7; y > -1; --y) {
-                    image[z][y] = table[7-z][7-y];
-                }
-            }
-            break;
-        case ANGLE_90:
-            for (int y = 0; y < 8; ++y) {
-                for (int z = 7; z > -1; --z) {
-                    image[z][y] = table[y][7-z];
-                }
-            }
-            break;
-        case ANGLE_180:
-            for (int z = 0; z < 8; ++z) {
-                for (int y = 0; y < 8; ++y) {
-                    image[z][y] = table[z][y];
-                }
-            }
-            break;
-        case ANGLE_270:
-            for (int y = 7; y > -1; --y) {
-                for (int z = 0; z < 8; ++z) {
-                    image[z][y] = table[7-y][z];
-                }
-            }
-            break;
-        }
-    }
-    else {
-        for (int y = 7; y > -1; --y) {
-            for (int z = 0; z < 8; ++z) {
-                image[z][y] = LED_OFF;
-            }
-        }
-    }
+    unpackGlyph(getImageInLayerX(imageCode, viewDirection, rotate), image);
 }
 
 
@@ -551,57 +542,29 @@ void LedCube::getImageInLayerX(Array2D_8_8& image, int imageCode, Direction view
  *
 ******************************************/
 void LedCube::copyLayerX(int xFrom, int xTo, bool clearXFrom) {
-    if (clearXFrom) {
-        for (int y = 0; y < 8; ++y) {
-            for (int z = 0; z < 8; ++z) {
-                ledsBuff[z][xTo][y] = ledsBuff[z][xFrom][y];
-                ledsBuff[z][xFrom][y] = LED_OFF;
-            }
-        }
-    }
-    else {
-        for (int y = 0; y < 8; ++y) {
-            for (int z = 0; z < 8; ++z) {
-                ledsBuff[z][xTo][y] = ledsBuff[z][xFrom][y];
-            }
-        }
+    for (int z = 0; z < 8; ++z) {
+        uint64_t& layer = ledsBuff.layers[z];
+        uint64_t row = uint64_t(ledsBuff.row(xFrom, z)) << (xTo * 8);
+        layer = (layer & ~FrameMask::rowBits(xTo)) | row;
+        if (clearXFrom)
+            layer &= ~FrameMask::rowBits(xFrom);
     }
 }
 
 void LedCube::copyLayerY(int yFrom, int yTo, bool clearYFrom) {
-    if (clearYFrom) {
-        for (int x = 0; x < 8; ++x) {
-            for (int z = 0; z < 8; ++z) {
-                ledsBuff[z][x][yTo] = ledsBuff[z][x][yFrom];
-                ledsBuff[z][x][yFrom] = LED_OFF;
-            }
-        }
-    }
-    else {
-        for (int x = 0; x < 8; ++x) {
-            for (int z = 0; z < 8; ++z) {
-                ledsBuff[z][x][yTo] = ledsBuff[z][x][yFrom];
-            }
-        }
+    for (int z = 0; z < 8; ++z) {
+        uint64_t& layer = ledsBuff.layers[z];
+        uint64_t col = ((layer >> yFrom) & FrameMask::colBits(0)) << yTo;
+        layer = (layer & ~FrameMask::colBits(yTo)) | col;
+        if (clearYFrom)
+            layer &= ~FrameMask::colBits(yFrom);
     }
 }
 
 void LedCube::copyLayerZ(int zFrom, int zTo, bool clearZFrom) {
-    if (clearZFrom) {
-        for (int x = 0; x < 8; ++x) {
-            for (int y = 0; y < 8; ++y) {
-                ledsBuff[zTo][x][y] = ledsBuff[zFrom][x][y];
-                ledsBuff[zFrom][x][y] = LED_OFF;
-            }
-        }
-    }
-    else {
-        for (int x = 0; x < 8; ++x) {
-            for (int y = 0; y < 8; ++y) {
-                ledsBuff[zTo][x][y] = ledsBuff[zFrom][x][y];
-            }
-        }
-    }
+    ledsBuff.layers[zTo] = ledsBuff.layers[zFrom];
+    if (clearZFrom)
+        ledsBuff.layers[zFrom] = 0;
 }
 
 
@@ -610,77 +573,12 @@ void LedCube::copyLayerZ(int zFrom, int zTo, bool clearZFrom) {
  *   line(A, B) is diagonal line
  *********************************/
 void LedCube::lightCube(const Vertex& A, const Vertex& B, FillType fill) {
-    int minX, minY, minZ, maxX, maxY, maxZ;
-    if (A.x > B.x) {
-        maxX = A.x;
-        minX = B.x;
-    } else {
-        maxX = B.x;
-        minX = A.x;
-    }
-
-    if (A.y > B.y) {
-        maxY = A.y;
-        minY = B.y;
-    } else {
-        maxY = B.y;
-        minY = A.y;
-    }
-
-    if (A.z > B.z) {
-        maxZ = A.z;
-        minZ = B.z;
-    } else {
-        maxZ = B.z;
-        minZ = A.z;
-    }
-
-    if (fill == FILL_EDGE) {
-        // parallel to z
-        lightRowXY(minX, minY, minZ, maxZ, LED_ON);
-        lightRowXY(minX, maxY, minZ, maxZ, LED_ON);
-        lightRowXY(maxX, minY, minZ, maxZ, LED_ON);
-        lightRowXY(maxX, maxY, minZ, maxZ, LED_ON);
-        // parallel to y
-        lightRowXZ(minX, minZ, minY + 1, maxY - 1, LED_ON);
-        lightRowXZ(minX, maxZ, minY + 1, maxY - 1, LED_ON);
-        lightRowXZ(maxX, minZ, minY + 1, maxY - 1, LED_ON);
-        lightRowXZ(maxX, maxZ, minY + 1, maxY - 1, LED_ON);
-        // parallel to x
-        lightRowYZ(minY, minZ, minX + 1, maxX - 1, LED_ON);
-        lightRowYZ(minY, maxZ, minX + 1, maxX - 1, LED_ON);
-        lightRowYZ(maxY, minZ, minX + 1, maxX - 1, LED_ON);
-        lightRowYZ(maxY, maxZ, minX + 1, maxX - 1, LED_ON);
-    }
-    else if (fill == FILL_SURFACE) {
-        for (int x = minX; x <= maxX; ++x) {
-            for (int y = minY; y <= minY; ++y) {
-                ledsBuff[minZ][x][y] = LED_ON;
-                ledsBuff[maxZ][x][y] = LED_ON;
-            }
-        }
-        for (int x = minX; x <= maxX; ++x) {
-            for (int z = minZ; z <= maxZ; ++z) {
-                ledsBuff[z][x][minY] = LED_ON;
-                ledsBuff[z][x][maxY] = LED_ON;
-            }
-        }
-        for (int y = minY; y <= maxY; ++y) {
-            for (int z = minZ; z <= maxZ; ++z) {
-                ledsBuff[z][minX][y] = LED_ON;
-                ledsBuff[z][maxX][y] = LED_ON;
-            }
-        }
-    }
-    else if (fill == FILL_SOLID) {
-        for (int x = minX; x <= maxX; ++x) {
-            for (int y = minY; y <= maxY; ++y) {
-                for (int z = minZ; z <= maxZ; ++z) {
-                    ledsBuff[z][x][y] = LED_ON;
-                }
-            }
-        }
-    }
+    if (fill == FILL_EDGE)
+        ledsBuff.fill(FrameMask::edges(A, B));
+    else if (fill == FILL_SURFACE)
+        ledsBuff.fill(FrameMask::shell(A, B));
+    else if (fill == FILL_SOLID)
+        ledsBuff.fill(FrameMask::box(A, B));
 }
 
 
@@ -723,64 +621,20 @@ void LedCube::lightSqure(const Vertex& A, const Vertex& B, FillType fill) {
 }
 
 
+// FILL_EDGE: the outline, else the whole rectangle
 void LedCube::lightSqureInLayerZ(int z, int minX, int maxX, int minY, int maxY, FillType fill) {
-    if (fill == FILL_EDGE) {
-        for (int x = minX; x <= maxX; ++x) {
-            ledsBuff[z][x][minY] = LED_ON;
-            ledsBuff[z][x][maxY] = LED_ON;
-        }
-        for (int y = minY + 1; y < maxY; ++y) {
-            ledsBuff[z][minX][y] = LED_ON;
-            ledsBuff[z][maxX][y] = LED_ON;
-        }
-    }
-    else {
-        for (int x = minX; x <= maxX; ++x) {
-            for (int y = minY; y <= maxY; ++y) {
-                ledsBuff[z][x][y] = LED_ON;
-            }
-        }
-    }
+    Vertex A(minX, minY, z), B(maxX, maxY, z);
+    ledsBuff.fill(fill == FILL_EDGE ? FrameMask::edges(A, B) : FrameMask::box(A, B));
 }
 
 void LedCube::lightSqureInLayerY(int y, int minX, int maxX, int minZ, int maxZ, FillType fill) {
-    if (fill == FILL_EDGE) {
-        for (int x = minX; x <= maxX; ++x) {
-            ledsBuff[minZ][x][y] = LED_ON;
-            ledsBuff[maxZ][x][y] = LED_ON;
-        }
-        for (int z = minZ + 1; z < maxZ; ++z) {
-            ledsBuff[z][minX][y] = LED_ON;
-            ledsBuff[z][maxX][y] = LED_ON;
-        }
-    }
-    else {
-        for (int x = minX; x <= maxX; ++x) {
-            for (int z = minZ; z <= maxZ; ++z) {
-                ledsBuff[z][x][y] = LED_ON;
-            }
-        }
-    }
+    Vertex A(minX, y, minZ), B(maxX, y, maxZ);
+    ledsBuff.fill(fill == FILL_EDGE ? FrameMask::edges(A, B) : FrameMask::box(A, B));
 }
 
 void LedCube::lightSqureInLayerX(int x, int minY, int maxY, int minZ, int maxZ, FillType fill) {
-    if (fill == FILL_EDGE) {
-        for (int y = minY; y <= maxY; ++y) {
-            ledsBuff[minZ][x][y] = LED_ON;
-            ledsBuff[maxZ][x][y] = LED_ON;
-        }
-        for (int z = minZ + 1; z < maxZ; ++z) {
-            ledsBuff[z][x][minY] = LED_ON;
-            ledsBuff[z][x][maxY] = LED_ON;
-        }
-    }
-    else {
-        for (int y = minY; y <= maxY; ++y) {
-            for (int z = minZ; z <= maxZ; ++z) {
-                ledsBuff[z][x][y] = LED_ON;
-            }
-        }
-    }
+    Vertex A(x, minY, minZ), B(x, maxY, maxZ);
+    ledsBuff.fill(fill == FILL_EDGE ? FrameMask::edges(A, B) : FrameMask::box(A, B));
 }
 
 
@@ -9,40 +9,142 @@
 /*                                                                  */
 /********************************************************************/
 #pragma once
-#include "./x_74hc154.h"
+#include "./backend/backend.h"
+#include "./scan_plan.h"
+#include "./frame_stream.h"
+#include "./animation_file.h"
 #include "../utility/enum.h"
 #include "../utility/coordinate.h"
-#include <mutex>
+#include "../utility/frame.h"
+#include "../utility/glyph_cache.h"
+#include "../utility/triple_buffer.h"
 #include <array>
+#include <atomic>
+#include <thread>
 
 #define Call(x) (x); LedCube::update();
 
 using LedState = char;
 
 
+// LED on with a brightness level (1 ~ 15, 0 means off)
+//   cube(x, y, z) = ledLevel(8);
+inline LedState ledLevel(int level) {
+    return level > 0 ? LedState(LED_LEVEL | (level & MaxLevel)) : LedState(LED_OFF);
+}
+
+
+/*********************************************
+ *  Reference to one bit of a packed Frame
+ *  (and to its brightness level)
+ *    cube(x, y, z) = LED_ON;
+ *    cube(x, y, z) = ledLevel(8);
+ *    if (cube(x, y, z) == LED_OFF) ...
+*********************************************/
+class LedRef {
+public:
+    LedRef(uint64_t& layer, uint64_t (&levels)[LevelBits], uint64_t mask) :
+        layer_(layer), levels_(levels), mask_(mask) {}
+
+    // LED_ON keeps the brightness level of the LED
+    LedRef& operator=(LedState state) {
+        if (state == LED_ON) {
+            layer_ |= mask_;
+        }
+        else if ((state & LED_LEVEL) && (state & MaxLevel)) {
+            layer_ |= mask_;
+            for (int b = 0; b < LevelBits; ++b) {
+                if (state & (1 << b))
+                    levels_[b] |= mask_;
+                else
+                    levels_[b] &= ~mask_;
+            }
+        }
+        else {
+            layer_ &= ~mask_;
+        }
+        return *this;
+    }
+
+    LedRef& operator=(const LedRef& other) {
+        return *this = (other == LED_ON) ? ledLevel(other.level()) : LedState(LED_OFF);
+    }
+
+    operator LedState() const {
+        return (layer_ & mask_) ? LED_ON : LED_OFF;
+    }
+
+    // brightness level (1 ~ 15) if on, 0 if off
+    int level() const {
+        if (!(layer_ & mask_))
+            return 0;
+        int level = 0;
+        for (int b = 0; b < LevelBits; ++b) {
+            if (levels_[b] & mask_)
+                level |= 1 << b;
+        }
+        return level;
+    }
+
+private:
+    uint64_t& layer_;
+    uint64_t (&levels_)[LevelBits];
+    uint64_t mask_;
+};
+
+
+/*********************************************
+ *  Scheduling of the refresh thread
+ *    all off by default (need root)
+*********************************************/
+struct RefreshOptions {
+    RefreshOptions() : cpu(-1), priority(0), lockMemory(false) {}
+
+    int  cpu;         // pin the thread to this core, -1: any core
+    int  priority;    // SCHED_FIFO priority (1 ~ 99), 0: normal scheduling
+    bool lockMemory;  // mlockall(), no page faults while scanning
+};
+
+
 class LedCube {
 public:
     LedCube() {}
     ~LedCube();
 
-    /*************************
+    /*********************************************
      * initialize
-    *************************/
-    void setup();
+     *   the cube takes the ownership of backend
+     *   return false if the backend setup failed
+     *   options failing to apply are only warned
+    *********************************************/
+    bool setup(CubeBackend* backend, const RefreshOptions& options = RefreshOptions());
 
     /*********************************************
      * copy and apply the LEDs state buffer
      * refresh the cube
+     *   never waits for the background thread
+     *   only the changed layers are recompiled
     *********************************************/
     static void update();
 
     /*********************************************
-     *  Quit background thread
+     *  Quit (and join) background thread
     *********************************************/
     static void quit();
 
+    /*********************************************
+     *  Stop from a signal handler (Ctrl+C)
+     *    requestStop() only sets a flag (async-
+     *    signal-safe), the handler is called later
+     *    on the thread of the effects, by its next
+     *    update() or sleepUs() (not while capturing)
+    *********************************************/
+    static void requestStop() { stopRequested.store(true, std::memory_order_relaxed); }
+    static void setStopHandler(void (*handler)()) { stopHandler = handler; }
+
     /**********************************
      *     Light off All LEDs
+     *     (and reset the brightness)
     **********************************/
     static void clear();
 
@@ -55,10 +157,10 @@ public:
     /****************************
      *     Led in (x, y, z)
     ****************************/
-    LedState& operator()(int x, int y, int z)
-        { return ledsBuff[z][x][y]; }
-    LedState& operator()(const Coordinate& coord)
-        { return ledsBuff[coord.z][coord.x][coord.y]; }
+    LedRef operator()(int x, int y, int z)
+        { return LedRef(ledsBuff.layers[z], levelsBuff[z], Frame::mask(x, y)); }
+    LedRef operator()(const Coordinate& coord)
+        { return LedRef(ledsBuff.layers[coord.z], levelsBuff[coord.z], Frame::mask(coord.x, coord.y)); }
 
 
     /***************************
@@ -73,6 +175,10 @@ public:
     void lightLayerY(int y, const Array2D_8_8& image);
     void lightLayerX(int x, const Array2D_8_8& image);
 
+    void lightLayerZ(int z, Glyph image);
+    void lightLayerY(int y, Glyph image);
+    void lightLayerX(int x, Glyph image);
+
     void lightLayerZ(int z, int imageCode, Direction viewDirection, Angle rotate = ANGLE_0);
     void lightLayerY(int y, int imageCode, Direction viewDirection, Angle rotate = ANGLE_0);
     void lightLayerX(int x, int imageCode, Direction viewDirection, Angle rotate = ANGLE_0);
@@ -92,6 +198,26 @@ public:
     void lightRowXZ(int x, int z, const std::array<LedState, 8>& state);
 
 
+    /*********************************************
+     *    Bulk drawing (see FrameMask)
+     *      lightMask(): on or off the LEDs of mask
+     *      blendMask(): the LEDs of mask from image
+     *    the brightness levels are not changed
+    *********************************************/
+    void lightMask(const Frame& mask, LedState state);
+    void blendMask(const Frame& mask, const Frame& image);
+
+
+    /*********************************************
+     *    All the LEDs as a Frame, to be moved
+     *    as a whole (see Frame::shiftZ() ...)
+     *      cube.setLeds(cube.getLeds().shiftZ(1));
+     *    the brightness levels are not changed
+    *********************************************/
+    const Frame& getLeds() const { return ledsBuff; }
+    void setLeds(const Frame& leds) { ledsBuff = leds; }
+
+
     /**************************
      *    light a line
     **************************/
@@ -100,11 +226,19 @@ public:
 
     /********************************
      *    Get Image in a layer
+     *      from the GlyphCache
+     *      all off if viewDirection
+     *      is not across the layer
+     *      font: see GlyphCache::get()
     ********************************/
     void getImageInLayerZ(Array2D_8_8& image, int imageCode, Direction viewDirection = Z_DESCEND, Angle rotate = ANGLE_0);
     void getImageInLayerY(Array2D_8_8& image, int imageCode, Direction viewDirection = Y_DESCEND, Angle rotate = ANGLE_0);
     void getImageInLayerX(Array2D_8_8& image, int imageCode, Direction viewDirection = X_DESCEND, Angle rotate = ANGLE_0);
 
+    Glyph getImageInLayerZ(int imageCode, Direction viewDirection = Z_DESCEND, Angle rotate = ANGLE_0, const Font* font = nullptr);
+    Glyph getImageInLayerY(int imageCode, Direction viewDirection = Y_DESCEND, Angle rotate = ANGLE_0, const Font* font = nullptr);
+    Glyph getImageInLayerX(int imageCode, Direction viewDirection = X_DESCEND, Angle rotate = ANGLE_0, const Font* font = nullptr);
+
 
     /******************************************
      *   Copy (or move) layer
@@ -143,37 +277,91 @@ public:
 
 
     /***********************************************************
+     *   Brightness level (1 ~ 15) of all the LEDs
+     *     each LED has its own level, see ledLevel()
+     *     LEDs are dimmed by bit angle modulation, the
+     *     refresh frequence doesn't change
+    ************************************************************/
+    static void setLevel(int level);
+
+
+    /***********************************************************
+     *   How long each LED is lit in one scan (nanoseconds)
      *   Influence:
      *      ==> the refresh frequence
      *      ==> the luminance of each led  ( ! ! ! )
-     *   The smaller the count, the brighter of the LEDs
+     *   0: reset to default
     ************************************************************/
-    enum { DefaultLoopCount = 150 };
-    static void setLoopCount(int count) {
-        if (count == 0)
-            loopCount = DefaultLoopCount;
-        else if (count < 4)
-            loopCount = 4;
+    enum { DefaultDwellNs = 800, MinDwellNs = 20, FrameGapNs = 25000 };
+    static void setDwellNs(int ns) {
+        if (ns == 0)
+            dwellNs = DefaultDwellNs;
+        else if (ns < MinDwellNs)
+            dwellNs = MinDwellNs;
         else
-            loopCount = count;
+            dwellNs = ns;
     }
+    static int getDwellNs() { return dwellNs; }
 
 
-private:
-    static void backgroundThread();
+    /***********************************************************
+     *   Time of the effects
+     *     sleepUs() sleeps until an absolute deadline (the last
+     *     one plus us), so the time spent drawing and in update()
+     *     doesn't make the effects drift
+     *
+     *   Capture (render ahead of time):
+     *     update() appends the frame to the stream instead
+     *     of showing it, sleepUs() only extends the frame
+     *     and moves the virtual time returned by nowUs()
+    ************************************************************/
+    static void sleepUs(uint64_t us);
+    static void sleepMs(int ms) {
+        if (ms > 0)
+            sleepUs(uint64_t(ms) * 1000);
+    }
+    static uint64_t nowUs();
 
-private:
-    static int vcc[8];
-    static X74hc154 x74hc154[4];
+    static void beginCapture(FrameStream* stream);
+    static void endCapture();
+    static bool isCapturing() { return capture != nullptr; }
+
+    // replace the buffer (leds and brightness) with a frame
+    static void setFrame(const Frame& leds, const uint64_t levels[8][LevelBits]);
+
+    // every frame shown by update() is also recorded (nullptr: stop)
+    static void setRecorder(AnimationWriter* recorder) { LedCube::recorder = recorder; }
 
-    static LedState leds[8][8][8];  // Z X Y
-    static LedState ledsBuff[8][8][8];  // Z X Y
 
-    static bool isRunning;
-    static bool isBackgroundThreadQuit;
-    static std::mutex mutex_;
+private:
+    enum { MaxLagNs = 100000000 };     // 100 ms
+    static void backgroundThread(RefreshOptions options);
+    static void pollStop();
+
+private:
+    static CubeBackend* backend_;
+
+    static TripleBuffer<ScanPlan> scanPlans;  // published frames, compiled for the background thread
+    static Frame ledsBuff;                    // modified by the effects
+    static uint64_t levelsBuff[8][LevelBits]; // [z][bit of level], brightness of each LED
+
+    // state of the last update(), to find the changed layers
+    static Frame publishedLeds;
+    static uint64_t publishedLevels[8][LevelBits];
+    static uint32_t layerVersions[8];         // bumped when the layer changes
+    static uint32_t version;
+
+    static AnimationWriter* recorder;
+    static FrameStream* capture;              // not null while capturing
+    static uint64_t captureUs;                // virtual time of the capture
+    static uint64_t deadlineNs;               // of the last sleepUs()
+
+    static std::thread refreshThread;
+    static std::atomic<bool> isRunning;
+    static std::atomic<bool> stopRequested;
+    static void (*stopHandler)();
     static bool setuped;
 
-    static int loopCount;
+    static std::atomic<int> dwellNs;
 };
 
@@ -10,47 +10,27 @@ extern LedCube cube;
 namespace ext {
 
 
-static void replaceAll(std::string& str, const std::string& src, const std::string& des) {
-    std::string::size_type pos = 0;
-    std::string::size_type srcLen = src.length();
-    std::string::size_type desLen = des.length();
-    pos = str.find(src, pos);
-    while (pos != std::string::npos) {
-        str.replace(pos, srcLen, des);
-        pos = src.find(src, pos + desLen);
+// "lhs = rhs": the LEDs where lhs - (rhs) is about 0
+//   the expression is compiled once, then evaluated
+//   for the whole cube in one batch, at time t
+//   (e.g. "z = 3.5 + 3*sin(x + t)")
+void getFrameOfFunction(std::string func, char leds[][8][8], double t) {
+    std::string::size_type equal = func.find('=');
+    if (equal != std::string::npos)
+        func = func.substr(0, equal) + "-(" + func.substr(equal + 1) + ")";
+
+    ExpressionEvaluator expEv;
+    if (!expEv.compile(func)) {
+        std::cout << func << ": " << expEv.getErrorDesc() << std::endl;
+        return;
     }
-}
-
-static void getValueZ(std::string func, int x, int y, char zArr[]) {
-
-}
-
-
-void getFrameOfFunction(std::string func, char leds[][8][8]) {
-    for (int x = 0; x < 8; ++x) {
-        for (int y = 0; y < 8; ++y) {
-            std::string expression = func;
-            replaceAll(expression, "x", std::to_string(x));
-            replaceAll(expression, "y", std::to_string(y));
-            replaceAll(expression, "=", "-(");
-            expression += ")";
-
-            std::cout << expression << std::endl;
-
-            ExpressionEvaluator expEv;
-            double val;
 
-            for (int z = 0; z < 8; ++z) {
-                std::string expTmp = expression;
-                replaceAll(expTmp, "z", std::to_string(z));
-                val = expEv.eval(expTmp);
-                if (val > -0.5 && val < 0.5)
-                    cube(x, y, z) = LED_ON;
-                    //leds[z][x][y] = LED_ON;
-                else
-                    cube(x, y, z) = LED_OFF;
-                    //leds[z][x][y] = LED_OFF;
-            }
+    uint64_t layers[8];
+    expEv.evalGrid(t, layers);
+    for (int z = 0; z < 8; ++z) {
+        for (int x = 0; x < 8; ++x) {
+            for (int y = 0; y < 8; ++y)
+                cube(x, y, z) = (layers[z] & Frame::mask(x, y)) ? LED_ON : LED_OFF;
         }
     }
 
@@ -69,9 +49,9 @@ void showStringInLayerZ(std::string str, int interval, int z, Direction viewDire
         cube.lightLayerZ(ch, z, viewDirection, rotate);
         cube.update();
         if (ch == ' ')
-            std::this_thread::sleep_for(std::chrono::milliseconds(interval / 2));
+            cube.sleepMs(interval / 2);
         else
-            std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+            cube.sleepMs(interval);
     }
 }
 
@@ -81,9 +61,9 @@ void showStringInLayerY(std::string str, int interval, int y, Direction viewDire
         cube.lightLayerY(ch, y, viewDirection, rotate);
         cube.update();
         if (ch == ' ')
-            std::this_thread::sleep_for(std::chrono::milliseconds(interval / 2));
+            cube.sleepMs(interval / 2);
         else
-            std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+            cube.sleepMs(interval);
     }
 }
 
@@ -93,9 +73,9 @@ void showStringInLayerX(std::string str, int interval, int x, Direction viewDire
         cube.lightLayerX(ch, x, viewDirection, rotate);
         cube.update();
         if (ch == ' ')
-            std::this_thread::sleep_for(std::chrono::milliseconds(interval / 2));
+            cube.sleepMs(interval / 2);
         else
-            std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+            cube.sleepMs(interval);
     }
 }
 
@@ -0,0 +1,495 @@
+#include "./eml_program.h"
+#include "./script.h"
+#include "./cube.h"
+#include "./frame_stream.h"
+#include "./scheduler.h"
+#include "../utility/utils.h"
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../effect/effect_registry.h"
+
+
+/**********************************************
+ *
+ *   Cache file (.emlc)
+ *
+ *     EmlcHeader
+ *     sources   (EmlcSource + filename) x sourceCount
+ *     steps     Step x stepCount  (8 bytes aligned)
+ *     text      textSize bytes
+ *
+**********************************************/
+struct EmlcHeader {
+    char magic[4];          // "EMLC"
+    uint32_t version;
+    uint32_t effectTable;   // EffectRegistry::hash()
+    uint32_t sourceCount;
+    uint32_t stepCount;
+    uint32_t textSize;
+    uint32_t stepsOffset;   // from the beginning of the file
+    uint32_t textOffset;
+};
+
+struct EmlcSource {
+    int64_t mtime;
+    int64_t size;
+    uint32_t filenameSize;  // followed by the filename, padded to 8 bytes
+    uint32_t reserved;
+};
+
+enum { EmlcVersion = 1, MaxDepth = 16 };
+
+static uint32_t align8(uint32_t n) {
+    return (n + 7) & ~uint32_t(7);
+}
+
+static bool statFile(const char* filename, int64_t& mtime, int64_t& size) {
+    struct stat st;
+    if (stat(filename, &st) != 0)
+        return false;
+    mtime = int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    size = st.st_size;
+    return true;
+}
+
+
+EmlProgram::~EmlProgram() {
+    unmap();
+}
+
+void EmlProgram::unmap() {
+    if (map_)
+        munmap(map_, mapSize_);
+    map_ = nullptr;
+    mapSize_ = 0;
+}
+
+std::string EmlProgram::cacheFileOf(const char* filename) {
+    std::string cacheFile(filename);
+    if (cacheFile.size() > 4 && cacheFile.compare(cacheFile.size() - 4, 4, ".eml") == 0)
+        return cacheFile + "c";
+    return cacheFile + ".emlc";
+}
+
+const char* EmlProgram::stepName(size_t i) const {
+    if (steps_[i].kind == STEP_SCRIPT)
+        return "<SCRIPT>";
+    if (steps_[i].kind == STEP_PARALLEL)
+        return "<PARALLEL>";
+    return EffectRegistry::entry(steps_[i].effect).tag.c_str();
+}
+
+
+bool EmlProgram::load(const char* filename, bool useCache) {
+    std::string cacheFile = cacheFileOf(filename);
+    if (useCache && loadCache(cacheFile))
+        return true;
+
+    if (!compile(filename))
+        return false;
+
+    // a read-only directory is not an error
+    if (useCache)
+        saveCache(cacheFile);
+    return true;
+}
+
+bool EmlProgram::compile(const char* filename) {
+    unmap();
+    ownedSteps_.clear();
+    ownedText_.clear();
+    sources_.clear();
+
+    bool ok = compileFile(filename, 0);
+
+    steps_ = ownedSteps_.data();
+    stepCount_ = ownedSteps_.size();
+    text_ = ownedText_.data();
+    textSize_ = ownedText_.size();
+    return ok;
+}
+
+bool EmlProgram::compileFile(const char* filename, int depth) {
+    if (depth >= MaxDepth) {
+        printf("<EML> nested too deep: %s\n", filename);
+        return false;
+    }
+
+    std::ifstream ifs(filename);
+    if (!ifs.is_open()) {
+        printf("Can't open %s\n", filename);
+        return false;
+    }
+
+    Source source;
+    source.filename = filename;
+    if (!statFile(filename, source.mtime, source.size))
+        return false;
+    sources_.push_back(source);
+
+    // 1. remove annotation
+    std::string text;
+    std::string line;
+    bool isCommenting = false;
+    while (getline(ifs, line)) {
+        util::trim(line);
+        if (line.empty())
+            continue;
+        if (isCommenting) {
+            if (line == "<END_COMMENT>")
+                isCommenting = false;
+            continue;
+        }
+        if (line == "<COMMENT>")
+            isCommenting = true;
+        else if (line == "<END><END>") {
+            text += line;
+            text += '\n';
+            break;
+        }
+        else if (line.substr(0, 2) != "<#") {
+            text += line;
+            text += '\n';
+        }
+    }
+    ifs.close();
+
+    // 2. parse text
+    //    the spans of the steps are offsets in the text pool,
+    //    nested files append their own text after this one
+    if (text.empty()) {
+        printf("[Warning] missing <END><END> in the end of the eml-file.\n");
+        return true;
+    }
+    FILE* fp = fmemopen(&text[0], text.size(), "r");
+    if (!fp)
+        return false;
+    uint32_t base = uint32_t(ownedText_.size());
+    ownedText_ += text;
+    bool ret = compileText(fp, base, depth);
+    fclose(fp);
+    if (!ret)
+        printf("Failed to parse %s\n", filename);
+    return ret;
+}
+
+bool EmlProgram::compileText(FILE* fp, uint32_t base, int depth) {
+    while (!feof(fp)) {
+        char tag[32] = { 0 };
+        fscanf(fp, "%31s", tag);
+        util::toUpperCase(tag, strlen(tag));
+
+        int effect = EffectRegistry::find(tag);
+        if (effect != -1) {
+            long start = ftell(fp);
+            if (!EffectRegistry::entry(effect).play(fp, false)) {
+                printf("Wrong parameters of %s\n", tag);
+                return false;
+            }
+            Step step = { STEP_EFFECT, 0, uint16_t(effect),
+                          uint32_t(base + start), uint32_t(ftell(fp) - start) };
+            ownedSteps_.push_back(step);
+        }
+
+        else if (strcmp(tag, "<SCRIPT>") == 0 || strcmp(tag, "<EML>") == 0) {
+            bool isScript = (tag[1] == 'S');
+            while (true) {
+                char tag1[32] = { 0 };
+                fscanf(fp, "%31s", tag1);
+                util::toUpperCase(tag1, strlen(tag1));
+                if (strcmp(tag1, "<FILE>") == 0) {
+                    char filename[256] = { 0 };
+                    fscanf(fp, "%255s", filename);
+                    if (isScript) {
+                        uint32_t length = uint32_t(strlen(filename));
+                        Step step = { STEP_SCRIPT, 0, 0,
+                                      uint32_t(base + ftell(fp) - length), length };
+                        ownedSteps_.push_back(step);
+                    }
+                    else if (!compileFile(filename, depth + 1)) {
+                        return false;
+                    }
+                }
+                else if (strcmp(tag1, "<END>") == 0) {
+                    break;
+                }
+                else {
+                    return false;
+                }
+            }
+        }
+
+        else if (strcmp(tag, "<PARALLEL>") == 0) {
+            if (!compileParallel(fp, base))
+                return false;
+        }
+
+        else if (strcmp(tag, "<END><END>") == 0) {
+            return true;
+        }
+
+        else if (strcmp(tag, "") == 0) {
+            printf("[Warning] missing <END><END> in the end of the eml-file.\n");
+            return true;
+        }
+
+        else {
+            printf("Unknown tag: %s\n", tag);
+            return false;
+        }
+    }
+    return true;
+}
+
+// <PARALLEL>
+//   [<BLEND> mode] <Effect> ... <END>      (BLEND_OR by default)
+//   ...
+// <END_PARALLEL>
+bool EmlProgram::compileParallel(FILE* fp, uint32_t base) {
+    size_t group = ownedSteps_.size();
+    Step head = { STEP_PARALLEL, 0, 0, 0, 0 };
+    ownedSteps_.push_back(head);
+
+    BlendMode mode = BLEND_OR;
+    while (true) {
+        char tag[32] = { 0 };
+        fscanf(fp, "%31s", tag);
+        util::toUpperCase(tag, strlen(tag));
+
+        int effect = EffectRegistry::find(tag);
+        if (effect != -1) {
+            if (ownedSteps_[group].length >= Scheduler::MaxTasks) {
+                printf("More than %d effects in <PARALLEL>\n", int(Scheduler::MaxTasks));
+                return false;
+            }
+            long start = ftell(fp);
+            if (!EffectRegistry::entry(effect).play(fp, false)) {
+                printf("Wrong parameters of %s\n", tag);
+                return false;
+            }
+            Step step = { STEP_EFFECT, uint8_t(mode), uint16_t(effect),
+                          uint32_t(base + start), uint32_t(ftell(fp) - start) };
+            ownedSteps_.push_back(step);
+            ++ownedSteps_[group].length;
+            mode = BLEND_OR;
+        }
+
+        else if (strcmp(tag, "<BLEND>") == 0) {
+            char name[32] = { 0 };
+            fscanf(fp, "%31s", name);
+            mode = util::getBlendMode(name);
+            if (mode == BLEND_ERROR) {
+                printf("Unknown blend mode: %s\n", name);
+                return false;
+            }
+        }
+
+        else if (strcmp(tag, "<END_PARALLEL>") == 0) {
+            return true;
+        }
+
+        else if (strcmp(tag, "") == 0) {
+            printf("Missing <END_PARALLEL>\n");
+            return false;
+        }
+
+        else {
+            printf("Unknown tag in <PARALLEL>: %s\n", tag);
+            return false;
+        }
+    }
+}
+
+
+bool EmlProgram::run(bool prerender) const {
+    for (size_t i = 0; i < stepCount_; ++i) {
+        const Step& step = steps_[i];
+        if (step.kind == STEP_PARALLEL) {
+            if (!runParallel(i, prerender))
+                return false;
+            i += step.length;
+            continue;
+        }
+        if (step.kind == STEP_SCRIPT) {
+            std::string filename(text_ + step.offset, step.length);
+            Script script;
+            script.run(filename.c_str());
+            continue;
+        }
+
+        // "r": fmemopen() doesn't write to the (read-only mapped) text
+        FILE* fp = fmemopen(const_cast<char*>(text_ + step.offset), step.length, "r");
+        if (!fp)
+            return false;
+        FrameStream stream;
+        if (prerender)
+            LedCube::beginCapture(&stream);
+        bool ok = EffectRegistry::entry(step.effect).play(fp, true);
+        fclose(fp);
+        if (prerender) {
+            LedCube::endCapture();
+            FramePlayer::play(stream);
+        }
+        if (!ok)
+            return false;
+    }
+    return true;
+}
+
+bool EmlProgram::runParallel(size_t group, bool prerender) const {
+    // each effect rendered on its own, from an empty cube
+    Scheduler scheduler;
+    for (uint32_t k = 1; k <= steps_[group].length; ++k) {
+        const Step& step = steps_[group + k];
+        FILE* fp = fmemopen(const_cast<char*>(text_ + step.offset), step.length, "r");
+        if (!fp)
+            return false;
+        FrameStream stream;
+        LedCube::clear();
+        LedCube::beginCapture(&stream);
+        LedCube::update();
+        bool ok = EffectRegistry::entry(step.effect).play(fp, true);
+        LedCube::endCapture();
+        fclose(fp);
+        if (!ok)
+            return false;
+        scheduler.add(new StreamTask(stream), BlendMode(step.blend));
+    }
+
+    if (!prerender) {
+        scheduler.run();
+        return true;
+    }
+    FrameStream stream;
+    LedCube::beginCapture(&stream);
+    scheduler.run();
+    LedCube::endCapture();
+    FramePlayer::play(stream);
+    return true;
+}
+
+
+bool EmlProgram::saveCache(const std::string& cacheFile) const {
+    std::string data(sizeof(EmlcHeader), '\0');
+
+    for (auto& source : sources_) {
+        EmlcSource s = { source.mtime, source.size, uint32_t(source.filename.size()), 0 };
+        data.append(reinterpret_cast<const char*>(&s), sizeof(s));
+        data += source.filename;
+        data.resize(align8(uint32_t(data.size())), '\0');
+    }
+
+    EmlcHeader header;
+    memcpy(header.magic, "EMLC", 4);
+    header.version = EmlcVersion;
+    header.effectTable = EffectRegistry::hash();
+    header.sourceCount = uint32_t(sources_.size());
+    header.stepCount = uint32_t(stepCount_);
+    header.textSize = uint32_t(textSize_);
+    header.stepsOffset = uint32_t(data.size());
+    header.textOffset = uint32_t(data.size() + stepCount_ * sizeof(Step));
+    memcpy(&data[0], &header, sizeof(header));
+
+    data.append(reinterpret_cast<const char*>(steps_), stepCount_ * sizeof(Step));
+    data.append(text_, textSize_);
+
+    // write aside, then replace: a reader never sees half a file
+    std::string tmpFile = cacheFile + ".tmp";
+    FILE* fp = fopen(tmpFile.c_str(), "wb");
+    if (!fp)
+        return false;
+    bool ok = fwrite(data.data(), 1, data.size(), fp) == data.size();
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok || rename(tmpFile.c_str(), cacheFile.c_str()) != 0) {
+        remove(tmpFile.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool EmlProgram::loadCache(const std::string& cacheFile) {
+    int fd = open(cacheFile.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(EmlcHeader)) {
+        close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return false;
+
+    const char* data = static_cast<const char*>(map);
+    const EmlcHeader* header = reinterpret_cast<const EmlcHeader*>(data);
+    bool ok = memcmp(header->magic, "EMLC", 4) == 0 &&
+              header->version == EmlcVersion &&
+              header->effectTable == EffectRegistry::hash() &&
+              header->stepsOffset % 8 == 0 &&
+              header->textOffset == header->stepsOffset + uint64_t(header->stepCount) * sizeof(Step) &&
+              uint64_t(header->textOffset) + header->textSize <= size;
+
+    // all the sources unchanged ?
+    std::vector<Source> sources;
+    size_t pos = sizeof(EmlcHeader);
+    for (uint32_t i = 0; ok && i < header->sourceCount; ++i) {
+        if (pos + sizeof(EmlcSource) > header->stepsOffset) {
+            ok = false;
+            break;
+        }
+        const EmlcSource* s = reinterpret_cast<const EmlcSource*>(data + pos);
+        pos += sizeof(EmlcSource);
+        if (pos + s->filenameSize > header->stepsOffset) {
+            ok = false;
+            break;
+        }
+        Source source;
+        source.filename.assign(data + pos, s->filenameSize);
+        pos = align8(uint32_t(pos + s->filenameSize));
+        ok = statFile(source.filename.c_str(), source.mtime, source.size) &&
+             source.mtime == s->mtime && source.size == s->size;
+        sources.push_back(source);
+    }
+
+    // all the spans inside the text ?
+    // (the steps of a <PARALLEL> group: effects only)
+    const Step* steps = reinterpret_cast<const Step*>(data + (ok ? header->stepsOffset : 0));
+    uint64_t groupEnd = 0;
+    for (uint32_t i = 0; ok && i < header->stepCount; ++i) {
+        const Step& step = steps[i];
+        if (step.kind == STEP_PARALLEL) {
+            ok = i >= groupEnd && step.length <= Scheduler::MaxTasks;
+            groupEnd = uint64_t(i) + 1 + step.length;
+            ok = ok && groupEnd <= header->stepCount;
+            continue;
+        }
+        ok = uint64_t(step.offset) + step.length <= header->textSize &&
+             ((step.kind == STEP_SCRIPT && i >= groupEnd) ||
+              (step.kind == STEP_EFFECT && step.effect < EffectRegistry::count() &&
+               step.blend <= BLEND_OVER));
+    }
+
+    if (!ok) {
+        munmap(map, size);
+        return false;
+    }
+
+    unmap();
+    ownedSteps_.clear();
+    ownedText_.clear();
+    sources_.swap(sources);
+    map_ = map;
+    mapSize_ = size;
+    steps_ = steps;
+    stepCount_ = header->stepCount;
+    text_ = data + header->textOffset;
+    textSize_ = header->textSize;
+    return true;
+}
+
@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+
+/*************************************************************
+ *   EmlProgram
+ *     an .eml file parsed once into a list of steps
+ *
+ *   compile:
+ *     - comments (<COMMENT> ... <END_COMMENT>, <#...) are
+ *       stripped in memory, no temp file
+ *     - the parameters of each effect are checked by its
+ *       readFromFP() and kept as a span of the stripped text
+ *     - nested <EML> files are inlined
+ *
+ *   run:
+ *     each effect reads its span again through fmemopen()
+ *     and is shown once (or rendered, then played)
+ *     the effects of a <PARALLEL> group are rendered, then
+ *     played together by a Scheduler
+ *
+ *   cache: <file>.emlc (see EmlcHeader in eml_program.cpp),
+ *     mmap-ed as is, rebuilt when any of the source files
+ *     changed
+*************************************************************/
+class EmlProgram {
+public:
+    enum StepKind : uint8_t {
+        STEP_EFFECT = 0,    // registered effect, parameters in text
+        STEP_SCRIPT = 1,    // script file, its name in text
+        STEP_PARALLEL = 2,  // the next length steps (effects) at once
+    };
+
+    struct Step {
+        uint8_t kind;
+        uint8_t blend;      // BlendMode of an effect in a <PARALLEL>
+        uint16_t effect;    // id in EffectRegistry (STEP_EFFECT)
+        uint32_t offset;    // span of text
+        uint32_t length;
+    };
+
+    EmlProgram() {}
+    ~EmlProgram();
+
+    EmlProgram(const EmlProgram&) = delete;
+    EmlProgram& operator=(const EmlProgram&) = delete;
+
+    // load the cache of the file if it is up to date,
+    // otherwise compile the file (and rewrite the cache)
+    bool load(const char* filename, bool useCache = true);
+
+    // compile the file, without any cache
+    bool compile(const char* filename);
+
+    bool saveCache(const std::string& cacheFile) const;
+    bool loadCache(const std::string& cacheFile);
+
+    // run all the steps, return false if a step failed
+    //   prerender: render each effect to a FrameStream first,
+    //              then play it on the absolute clock
+    bool run(bool prerender = false) const;
+
+    size_t stepCount() const { return stepCount_; }
+    const Step& step(size_t i) const { return steps_[i]; }
+    const char* stepName(size_t i) const;
+
+    static std::string cacheFileOf(const char* filename);
+
+private:
+    struct Source {
+        std::string filename;
+        int64_t mtime;
+        int64_t size;
+    };
+
+    bool compileFile(const char* filename, int depth);
+    bool compileText(FILE* fp, uint32_t base, int depth);
+    bool compileParallel(FILE* fp, uint32_t base);
+    bool runParallel(size_t group, bool prerender) const;
+    void unmap();
+
+    // owned (compiled) or mmap-ed (cache)
+    std::vector<Step> ownedSteps_;
+    std::string ownedText_;
+    std::vector<Source> sources_;
+
+    void* map_ = nullptr;
+    size_t mapSize_ = 0;
+
+    const Step* steps_ = nullptr;
+    size_t stepCount_ = 0;
+    const char* text_ = nullptr;
+    size_t textSize_ = 0;
+};
+
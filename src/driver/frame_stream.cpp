@@ -0,0 +1,68 @@
+#include "./frame_stream.h"
+#include "./cube.h"
+#include <cerrno>
+#include <cstring>
+
+
+void FrameStream::append(const Frame& leds, const uint64_t levels[8][LevelBits]) {
+    frames_.emplace_back();
+    TimedFrame& frame = frames_.back();
+    frame.leds = leds;
+    memcpy(frame.levels, levels, sizeof(frame.levels));
+    frame.durationUs = 0;
+}
+
+bool FrameStream::extend(uint32_t us) {
+    if (frames_.empty())
+        return false;
+    uint64_t duration = uint64_t(frames_.back().durationUs) + us;
+    frames_.back().durationUs = duration > UINT32_MAX ? UINT32_MAX : uint32_t(duration);
+    return true;
+}
+
+uint64_t FrameStream::totalUs() const {
+    uint64_t total = 0;
+    for (auto& frame : frames_)
+        total += frame.durationUs;
+    return total;
+}
+
+
+bool FrameCursor::advance(uint64_t us) {
+    offsetUs_ += us;
+    while (!done() && offsetUs_ >= (*stream_)[index_].durationUs) {
+        offsetUs_ -= (*stream_)[index_].durationUs;
+        ++index_;
+    }
+    return !done();
+}
+
+
+FramePlayer::FramePlayer() {
+    clock_gettime(CLOCK_MONOTONIC, &deadline_);
+}
+
+void FramePlayer::present(const TimedFrame& frame) {
+    LedCube::setFrame(frame.leds, frame.levels);
+    LedCube::update();
+
+    // the end of frame i is the start time plus the durations
+    // of frames 0 ~ i, wherever update() took long or not
+    deadline_.tv_sec += frame.durationUs / 1000000;
+    deadline_.tv_nsec += long(frame.durationUs % 1000000) * 1000;
+    if (deadline_.tv_nsec >= 1000000000) {
+        deadline_.tv_nsec -= 1000000000;
+        ++deadline_.tv_sec;
+    }
+    // interrupted by a signal (SIGUSR1): sleep again
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline_, nullptr) == EINTR) {
+        //;
+    }
+}
+
+void FramePlayer::play(const FrameStream& stream) {
+    FramePlayer player;
+    for (size_t i = 0; i < stream.size(); ++i)
+        player.present(stream[i]);
+}
+
@@ -0,0 +1,94 @@
+#pragma once
+#include "../utility/enum.h"
+#include "../utility/frame.h"
+#include <cstdint>
+#include <time.h>
+#include <vector>
+
+
+/*************************************************************
+ *   TimedFrame: what the cube shows, and for how long
+ *     leds:   on / off
+ *     levels: [z][bit of level], brightness of each LED
+*************************************************************/
+struct TimedFrame {
+    Frame leds;
+    uint64_t levels[8][LevelBits];
+    uint32_t durationUs;
+};
+
+
+/*************************************************************
+ *   FrameStream
+ *     an effect rendered ahead of time, (frame, duration)s
+ *
+ *   Filled by LedCube while capturing (see beginCapture()):
+ *     update()  ==> append(), duration 0
+ *     sleepUs() ==> extend() the last frame
+*************************************************************/
+class FrameStream {
+public:
+    void append(const Frame& leds, const uint64_t levels[8][LevelBits]);
+
+    // the last frame stays for us more microseconds
+    // (false if the stream is empty)
+    bool extend(uint32_t us);
+
+    void clear() { frames_.clear(); }
+    bool empty() const { return frames_.empty(); }
+    size_t size() const { return frames_.size(); }
+    const TimedFrame& operator[](size_t i) const { return frames_[i]; }
+
+    uint64_t totalUs() const;
+
+private:
+    std::vector<TimedFrame> frames_;
+};
+
+
+/*************************************************************
+ *   FrameCursor
+ *     a position in a FrameStream, moved by elapsed time
+ *     (several cursors play streams side by side, see
+ *     Scheduler)
+*************************************************************/
+class FrameCursor {
+public:
+    explicit FrameCursor(const FrameStream& stream) : stream_(&stream) {}
+
+    // false once past the end of the stream
+    bool advance(uint64_t us);
+    bool done() const { return index_ >= stream_->size(); }
+
+    // the frame shown now (the last one once done)
+    const TimedFrame& frame() const {
+        return (*stream_)[done() ? stream_->size() - 1 : index_];
+    }
+
+private:
+    const FrameStream* stream_;
+    size_t index_ = 0;
+    uint64_t offsetUs_ = 0;     // time spent in frame index_
+};
+
+
+/*************************************************************
+ *   FramePlayer
+ *     present frames on an absolute monotonic clock
+ *     (clock_nanosleep TIMER_ABSTIME), so the time spent in
+ *     update() never accumulates
+*************************************************************/
+class FramePlayer {
+public:
+    // the clock starts now
+    FramePlayer();
+
+    // show the frame, then wait until its end
+    void present(const TimedFrame& frame);
+
+    static void play(const FrameStream& stream);
+
+private:
+    struct timespec deadline_;
+};
+
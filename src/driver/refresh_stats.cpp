@@ -0,0 +1,56 @@
+#include "./refresh_stats.h"
+#include "../utility/delay.h"
+
+std::atomic<uint64_t> RefreshStats::passes(0);
+std::atomic<uint64_t> RefreshStats::frames(0);
+Histogram RefreshStats::scan;
+Histogram RefreshStats::publish;
+Histogram RefreshStats::frame;
+uint64_t RefreshStats::startNs = 0;
+uint64_t RefreshStats::lastPublishNs = 0;
+std::atomic<bool> RefreshStats::dumpRequested(false);
+
+
+void RefreshStats::reset() {
+    passes.store(0, std::memory_order_relaxed);
+    frames.store(0, std::memory_order_relaxed);
+    scan.reset();
+    publish.reset();
+    frame.reset();
+    startNs = util::SpinDelay::nowNs();
+    lastPublishNs = 0;
+}
+
+void RefreshStats::recordPublish(uint64_t start, uint64_t end) {
+    frames.fetch_add(1, std::memory_order_relaxed);
+    publish.record(end - start);
+    if (lastPublishNs)
+        frame.record(start - lastPublishNs);
+    lastPublishNs = start;
+}
+
+void RefreshStats::dump(FILE* fp) {
+    double seconds = (util::SpinDelay::nowNs() - startNs) / 1e9;
+    if (seconds <= 0)
+        seconds = 1e-9;
+    uint64_t p = passes.load(std::memory_order_relaxed);
+    uint64_t f = frames.load(std::memory_order_relaxed);
+
+    fprintf(fp, "Refresh stats (%.1f s)\n", seconds);
+    fprintf(fp, "  passes  %-10llu %.1f /s\n", (unsigned long long)p, p / seconds);
+    fprintf(fp, "  frames  %-10llu %.1f /s\n", (unsigned long long)f, f / seconds);
+    scan.print(fp, "scan pass");
+    publish.print(fp, "update()");
+    frame.print(fp, "frame interval");
+    fflush(fp);
+}
+
+bool RefreshStats::dumpToFile(const char* filename) {
+    FILE* fp = fopen(filename, "w");
+    if (!fp)
+        return false;
+    dump(fp);
+    fclose(fp);
+    return true;
+}
+
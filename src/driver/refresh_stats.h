@@ -0,0 +1,59 @@
+#pragma once
+#include "../utility/histogram.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+
+/*************************************************************
+ *   RefreshStats
+ *     telemetry of the refresh loop
+ *
+ *     passes       scans of the whole cube (background thread)
+ *     scan         duration of one pass
+ *     publish      duration of LedCube::update()
+ *     frame        interval between two update() (effects)
+ *
+ *   dump():  on demand (SIGUSR1, see requestDump())
+ *            or to a file at exit
+*************************************************************/
+class RefreshStats {
+public:
+    // start counting from now on
+    static void reset();
+
+    /*************************
+     *  background thread
+    *************************/
+    static void recordPass(uint64_t scanNs) {
+        passes.fetch_add(1, std::memory_order_relaxed);
+        scan.record(scanNs);
+    }
+
+    /*************************
+     *  update()
+    *************************/
+    static void recordPublish(uint64_t startNs, uint64_t endNs);
+
+    // async-signal-safe, the dump is done by the next update()
+    static void requestDump() { dumpRequested.store(true, std::memory_order_relaxed); }
+    static bool takeDumpRequest() {
+        return dumpRequested.load(std::memory_order_relaxed) &&
+               dumpRequested.exchange(false, std::memory_order_relaxed);
+    }
+
+    static void dump(FILE* fp);
+    static bool dumpToFile(const char* filename);
+
+private:
+    static std::atomic<uint64_t> passes;
+    static std::atomic<uint64_t> frames;
+    static Histogram scan;
+    static Histogram publish;
+    static Histogram frame;
+
+    static uint64_t startNs;
+    static uint64_t lastPublishNs;  // only touched by update()
+    static std::atomic<bool> dumpRequested;
+};
+
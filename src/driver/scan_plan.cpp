@@ -0,0 +1,66 @@
+#include "./scan_plan.h"
+
+
+void ScanPlan::compile(const Frame& frame, const uint64_t levels[8][LevelBits], const uint32_t layerVersions[8]) {
+    // all lit LEDs at MaxLevel ?
+    bool fullLevel = true;
+    for (int z = 0; z < 8 && fullLevel; ++z) {
+        for (int b = 0; b < LevelBits; ++b) {
+            if (frame.layers[z] & ~levels[z][b]) {
+                fullLevel = false;
+                break;
+            }
+        }
+    }
+
+    // the planes are laid out differently, compile all
+    int count = fullLevel ? 1 : int(LevelBits);
+    bool all = count != planeCount;
+    planeCount = count;
+
+    for (int z = 0; z < 8; ++z) {
+        if (!all && versions[z] == layerVersions[z])
+            continue;
+        if (fullLevel) {
+            compileLayer(planes[0], z, frame.layers[z]);
+        }
+        else {
+            for (int b = 0; b < LevelBits; ++b)
+                compileLayer(planes[b], z, frame.layers[z] & levels[z][b]);
+        }
+        versions[z] = layerVersions[z];
+    }
+
+    if (fullLevel) {
+        planes[0].weight = MaxLevel;
+        planes[0].idle = 0;
+        return;
+    }
+
+    int lit = 0;
+    for (int z = 0; z < 8; ++z)
+        lit += __builtin_popcountll(frame.layers[z]);
+
+    for (int b = 0; b < LevelBits; ++b) {
+        int n = 0;
+        for (int z = 0; z < 8; ++z)
+            n += planes[b].count[z];
+        planes[b].weight = 1 << b;
+        planes[b].idle = lit - n;
+    }
+}
+
+void ScanPlan::compileLayer(Plane& plane, int z, uint64_t layer) {
+    int n = 0;
+    // bit (x * 8 + y), lowest first
+    for (uint64_t bits = layer; bits; bits &= bits - 1) {
+        int bit = __builtin_ctzll(bits);
+        int x = bit >> 3;
+        int y = bit & 7;
+        plane.entries[z][n].decoder = x / 2;
+        plane.entries[z][n].code = y + 8 * (x % 2);
+        ++n;
+    }
+    plane.count[z] = n;
+}
+
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include "../utility/enum.h"
+#include "../utility/frame.h"
+
+
+/***************************************************************
+ *   ScanPlan
+ *     a frame compiled for the background thread:
+ *     only the LEDs to light, grouped by layer, already
+ *     translated to (decoder, output code) of the 74HC154s
+ *
+ *   Brightness: bit angle modulation
+ *     plane b holds the LEDs whose level has bit b set,
+ *     and is lit for weight = 2^b (of 15) of the full time.
+ *     If all the lit LEDs are at MaxLevel, there is only
+ *     one plane with weight 15.
+ *
+ *   Incremental: each layer remembers the version it was
+ *     compiled from, compile() only redoes the layers whose
+ *     version changed since
+ *
+ *   entries of layer z in plane p:  [begin(p, z), end(p, z))
+***************************************************************/
+struct ScanPlan {
+    struct Entry {
+        uint8_t decoder;    // x / 2
+        uint8_t code;       // y + 8 * (x % 2)
+    };
+
+    struct Plane {
+        Entry entries[8][64];
+        uint8_t count[8];   // entries of each layer
+        uint8_t weight;     // 1 ~ 15
+        uint16_t idle;      // lit LEDs not in this plane (to keep the time constant)
+    };
+
+    ScanPlan() : planeCount(0) {
+        for (int z = 0; z < 8; ++z)
+            versions[z] = 0;
+    }
+
+    Plane planes[LevelBits];
+    int planeCount;
+    uint32_t versions[8];   // version of each compiled layer
+
+    const Entry* begin(int p, int z) const { return planes[p].entries[z]; }
+    const Entry* end(int p, int z) const { return planes[p].entries[z] + planes[p].count[z]; }
+
+    // frame: LEDs on / off
+    // levels: [z][bit of level]
+    // layerVersions: current version of each layer (see LedCube::update())
+    void compile(const Frame& frame, const uint64_t levels[8][LevelBits], const uint32_t layerVersions[8]);
+
+private:
+    static void compileLayer(Plane& plane, int z, uint64_t layer);
+};
+
@@ -0,0 +1,61 @@
+#include "./scheduler.h"
+#include "./cube.h"
+#include <utility>
+
+
+StreamTask::StreamTask(FrameStream& stream) : cursor_(stream_) {
+    std::swap(stream_, stream);
+}
+
+bool StreamTask::tick(uint64_t us, Frame& leds) {
+    if (stream_.empty())
+        return false;
+    bool running = cursor_.advance(us - lastUs_);
+    lastUs_ = us;
+    leds = cursor_.frame().leds;
+    return running;
+}
+
+
+bool Scheduler::add(Task* task, BlendMode mode, uint64_t startUs) {
+    std::unique_ptr<Task> owned(task);
+    int layer = compositor_.addLayer(mode);
+    if (layer < 0)
+        return false;
+    Entry entry;
+    entry.task = std::move(owned);
+    entry.layer = layer;
+    entry.startUs = startUs;
+    entry.finished = false;
+    tasks_.push_back(std::move(entry));
+    return true;
+}
+
+void Scheduler::run() {
+    uint64_t nowUs = 0;
+    while (true) {
+        size_t running = 0;
+        for (auto& entry : tasks_) {
+            if (entry.finished || nowUs < entry.startUs) {
+                running += !entry.finished;
+                continue;
+            }
+            Frame& leds = compositor_.layer(entry.layer);
+            if (entry.task->tick(nowUs - entry.startUs, leds)) {
+                ++running;
+            }
+            else {
+                // gone with its last frame
+                entry.finished = true;
+                leds.clear();
+            }
+        }
+
+        compositor_.render();
+        if (running == 0)
+            break;
+        LedCube::sleepUs(tickUs_);
+        nowUs += tickUs_;
+    }
+}
+
@@ -0,0 +1,94 @@
+#pragma once
+#include "./compositor.h"
+#include "./frame_stream.h"
+#include "../utility/enum.h"
+#include "../utility/frame.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+/*************************************************************
+ *   Task: an effect that can be resumed
+ *     tick() draws the frame of the moment and returns,
+ *     instead of sleeping like the effects do
+*************************************************************/
+class Task {
+public:
+    virtual ~Task() {}
+
+    // draw the frame us after the start of the task in leds,
+    // false once the task has finished
+    virtual bool tick(uint64_t us, Frame& leds) = 0;
+};
+
+
+/*************************************************************
+ *   StreamTask
+ *     a (blocking) effect rendered ahead into a FrameStream
+ *     (LedCube::beginCapture()), played by a FrameCursor
+*************************************************************/
+class StreamTask : public Task {
+public:
+    // the stream is moved into the task
+    explicit StreamTask(FrameStream& stream);
+    StreamTask(const StreamTask&) = delete;
+    StreamTask& operator=(const StreamTask&) = delete;
+
+    bool tick(uint64_t us, Frame& leds) override;
+
+private:
+    FrameStream stream_;
+    FrameCursor cursor_;
+    uint64_t lastUs_ = 0;
+};
+
+
+/*************************************************************
+ *   Scheduler
+ *     several tasks advanced on one fixed tick, each drawing
+ *     in its own layer of a Compositor, so effects overlap
+ *     without a thread each
+ *
+ *   Every tick: the running tasks draw, the layers are
+ *   rendered, then LedCube::sleepUs(tickUs) (an absolute
+ *   deadline, virtual time while capturing)
+ *
+ *     Scheduler scheduler;
+ *     scheduler.add(new StreamTask(rain));
+ *     scheduler.add(new StreamTask(text), BLEND_XOR, 500000);
+ *     scheduler.run();
+*************************************************************/
+class Scheduler {
+public:
+    enum { DefaultTickUs = 10000, MaxTasks = Compositor::MaxLayers };
+
+    explicit Scheduler(uint32_t tickUs = DefaultTickUs) : tickUs_(tickUs > 0 ? tickUs : 1) {}
+
+    // the scheduler owns the task (deleted even if it is refused)
+    //   mode:    how its layer is blended over the previous ones
+    //   startUs: delay from the beginning of run()
+    // false if there are already MaxTasks
+    bool add(Task* task, BlendMode mode = BLEND_OR, uint64_t startUs = 0);
+    size_t taskCount() const { return tasks_.size(); }
+
+    // tick until all the tasks have finished
+    void run();
+
+    // the layers of the tasks, in the order they were added
+    // (masks, visibility ...)
+    Compositor& compositor() { return compositor_; }
+
+private:
+    struct Entry {
+        std::unique_ptr<Task> task;
+        int layer;
+        uint64_t startUs;
+        bool finished;
+    };
+
+    uint32_t tickUs_;
+    std::vector<Entry> tasks_;
+    Compositor compositor_;
+};
+
@@ -85,7 +85,7 @@ bool Script::parseCmd(const std::string& cmd, std::stringstream& ssLine) {
 bool Script::cmdSleepMs(std::stringstream& ssLine) {
     int ms; 
     if (ssLine >> ms) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(ms));        
+        cube.sleepMs(ms);
         return true;
     }
     return false;
@@ -1,3 +1,5 @@
+#ifdef LEDCUBE_WITH_WIRINGPI
+
 #include "./x_74hc154.h"
 #include <iostream>
 #include <wiringPi.h>
@@ -60,3 +62,4 @@ void X74hc154::setOutput(char code) {
     digitalWrite(pinA, input[3]);
 }
 
+#endif // LEDCUBE_WITH_WIRINGPI
@@ -1,4 +1,8 @@
 #include "./breath_cube.h"
+#include "./effect_registry.h"
+
+REGISTER_EFFECT("<BREATHCUBE>", BreathCubeEffect);
+
 
 void BreathCubeEffect::show() {
     for (auto& event : events_) {
@@ -12,22 +16,24 @@ void BreathCubeEffect::show(const Coordinate& A, const Coordinate& B,
 {
     Call(cube.clear());
 
-    cube.setLoopCount(8);
+    // one breath takes as long as the old 8 ~ 80 loop count sweep (72 steps)
+    int stepMs = interval1 * 72 / (MaxLevel - 1);
+
+    cube.setLevel(1);
     cube.lightCube(A, B, fillType);
     cube.update();
     for (int k = 0; k < count; ++k) {
-        for (int i = 8; i < 80; ++i) {
-            cube.setLoopCount(i);
-            sleepMs(interval1);
+        for (int level = 1; level < MaxLevel; ++level) {
+            Call(cube.setLevel(level));
+            sleepMs(stepMs);
         }
-        for (int i = 80; i > 7; --i) {
-            cube.setLoopCount(i);
-            sleepMs(interval1);
+        for (int level = MaxLevel; level > 0; --level) {
+            Call(cube.setLevel(level));
+            sleepMs(stepMs);
         }
     }
 
     sleepMs(interval2);
-    cube.setLoopCount(0);
     Call(cube.clear());
 }
 
@@ -1,6 +1,9 @@
 #include "./cube_size_from_inner.h"
+#include "./effect_registry.h"
 #include "../driver/cube_extend.h"
 
+REGISTER_EFFECT("<CUBESIZEFROMINNER>", CubeSizeFromInnerEffect);
+
 
 void CubeSizeFromInnerEffect::show() {
     for (auto& event : events_) {
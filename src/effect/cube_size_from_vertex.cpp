@@ -1,8 +1,11 @@
 #include "cube_size_from_vertex.h"
+#include "./effect_registry.h"
 #include "../driver/cube_extend.h"
 
 extern LedCube cube;
 
+REGISTER_EFFECT("<CUBESIZEFROMVERTEX>", CubeSizeFromVertexEffect);
+
 
 void CubeSizeFromVertexEffect::show() {
     for (auto& event : events_) {
@@ -1,6 +1,9 @@
 #include "drop_line.h"
+#include "./effect_registry.h"
 #include "../utility/image_lib.h"
 
+REGISTER_EFFECT("<DROPLINE>", DropLineEffect);
+
 
 void DropLineEffect::show() {
     for (auto& event : events_) {
@@ -1,7 +1,10 @@
 #include "drop_point.h"
+#include "./effect_registry.h"
 #include "../utility/image_lib.h"
 #include "../utility/utils.h"
 
+REGISTER_EFFECT("<DROPPOINT>", DropPointEffect);
+
 
 void DropPointEffect::show() {
     for (auto& event : events_) {
@@ -21,10 +24,10 @@ void DropPointEffect::show(int imageCode, Direction viewDirection, Direction dro
         sleepMs(interval2);
     }
 
-    LedCube::Array2D_8_8 image;
+    Glyph image;
 
     if (viewDirection == X_ASCEND || viewDirection == X_DESCEND) {
-        cube.getImageInLayerX(image, imageCode, viewDirection, rotate);
+        image = cube.getImageInLayerX(imageCode, viewDirection, rotate, font_);
         if (dropDirection == X_ASCEND) {
             Call(cube.lightLayerX(0, image));
             sleepMs(interval1);
@@ -152,7 +155,7 @@ void DropPointEffect::show(int imageCode, Direction viewDirection, Direction dro
     }//viewDirection
 
     else if (viewDirection == Y_ASCEND || viewDirection == Y_DESCEND) {
-        cube.getImageInLayerY(image, imageCode, viewDirection, rotate);
+        image = cube.getImageInLayerY(imageCode, viewDirection, rotate, font_);
         if (dropDirection == Y_ASCEND) {
             Call(cube.lightLayerY(0, image));
             sleepMs(interval1);
@@ -280,7 +283,7 @@ void DropPointEffect::show(int imageCode, Direction viewDirection, Direction dro
     } //viewDirection
 
     else if (viewDirection == Z_ASCEND || viewDirection == Z_DESCEND) {
-        cube.getImageInLayerZ(image, imageCode, viewDirection, rotate);
+        image = cube.getImageInLayerZ(imageCode, viewDirection, rotate, font_);
         if (dropDirection == Z_ASCEND) {
             Call(cube.lightLayerZ(0, image));
             sleepMs(interval1);
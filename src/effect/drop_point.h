@@ -60,5 +60,6 @@ public:
 protected:
     std::vector<int> imagesCode_;
     std::vector<Event> events_;
+    const Font* font_ = nullptr;        // nullptr: ImageLib only
 };
 
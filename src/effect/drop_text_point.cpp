@@ -1,14 +1,19 @@
 #include "./drop_text_point.h"
-#include "../utility/image_lib.h"
+#include "./effect_registry.h"
+#include "../utility/font.h"
+
+REGISTER_EFFECT("<DROPTEXTPOINT>", DropTextPointEffect);
 
 
 void DropTextPointEffect::setText(const std::string& str) {
     string_ = str;
-    ImageLib::validate(string_);
-    DropPointEffect::clearImagesCode();
-    for (auto ch : string_) {
-        DropPointEffect::emplaceImagesCode(ch);
-    }
+    DropPointEffect::setImagesCode(Font::toImagesCode(string_, font_));
+}
+
+void DropTextPointEffect::setFont(const Font* font) {
+    font_ = font;
+    if (!string_.empty())
+        this->setText(string_);
 }
 
 
@@ -36,6 +41,13 @@ bool DropTextPointEffect::readFromFP(FILE* fp) {
                 }
             }
         }
+        else if (strcmp(tag1, "<FONT>") == 0) {
+            char font[256] = { 0 };
+            fscanf(fp, "%255s", font);
+            this->setFont(Font::findOrLoad(font));
+            if (!font_)
+                printf("Can't find font %s\n", font);
+        }
         else if (strcmp(tag1, "<EVENTS>") == 0) {
             while (true) {
                 char tag2[32] = { 0 };
@@ -5,6 +5,8 @@
 class DropTextPointEffect : public DropPointEffect {
 public:
     void setText(const std::string& str);
+    // nullptr: ImageLib only (the text is upper-cased)
+    void setFont(const Font* font);
 
 public:
     virtual bool readFromFP(FILE* fp);
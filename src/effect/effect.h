@@ -13,24 +13,21 @@ extern LedCube cube;
 
 class Effect {
 public:
+    // the clock of LedCube: virtual while rendering ahead of time
     void showMillseconds(int millseconds) {
+        uint64_t start = LedCube::nowUs();
         while (1) {
-            auto start = std::chrono::system_clock::now();
             show();
-            auto end = std::chrono::system_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-            if (duration.count() >= millseconds)
+            if (LedCube::nowUs() - start >= uint64_t(millseconds) * 1000)
                 break;
         }
     }
 
     void showSeconds(int seconds) {
+        uint64_t start = LedCube::nowUs();
         while (1) {
-            auto start = std::chrono::system_clock::now();
             show();
-            auto end = std::chrono::system_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::seconds>(end - start);
-            if (duration.count() >= seconds)
+            if (LedCube::nowUs() - start >= uint64_t(seconds) * 1000000)
                 break;
         }
     }
@@ -60,16 +57,15 @@ public:
 protected:
     void sleepUs(int microS) {
         if (microS > 0)
-            std::this_thread::sleep_for(std::chrono::microseconds(microS));
+            LedCube::sleepUs(microS);
     }
 
     void sleepMs(int milliS) {
-        if (milliS > 0)
-            std::this_thread::sleep_for(std::chrono::milliseconds(milliS));
+        LedCube::sleepMs(milliS);
     }
 
     void sleepS(int s) {
         if (s > 0)
-            std::this_thread::sleep_for(std::chrono::seconds(s));
+            LedCube::sleepUs(uint64_t(s) * 1000000);
     }
 };
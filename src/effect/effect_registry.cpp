@@ -0,0 +1,49 @@
+#include "./effect_registry.h"
+#include <algorithm>
+#include <unordered_map>
+
+// function statics: the registrars of the effects run
+// during static initialization, in any order
+static std::unordered_map<std::string, int>& index() {
+    static std::unordered_map<std::string, int> index;
+    return index;
+}
+
+std::vector<EffectRegistry::Entry>& EffectRegistry::entries() {
+    static std::vector<Entry> entries;
+    return entries;
+}
+
+
+bool EffectRegistry::add(const char* tag, Play play) {
+    std::vector<Entry>& all = entries();
+    Entry entry = { tag, play };
+    auto pos = std::lower_bound(all.begin(), all.end(), entry,
+            [](const Entry& a, const Entry& b) { return a.tag < b.tag; });
+    if (pos != all.end() && pos->tag == entry.tag) {
+        fprintf(stderr, "Effect %s registered twice\n", tag);
+        return false;
+    }
+    all.insert(pos, entry);
+
+    // keep the ids (positions) up to date
+    for (int i = 0; i < int(all.size()); ++i)
+        index()[all[i].tag] = i;
+    return true;
+}
+
+int EffectRegistry::find(const std::string& tag) {
+    auto it = index().find(tag);
+    return it == index().end() ? -1 : it->second;
+}
+
+uint32_t EffectRegistry::hash() {
+    uint32_t hash = 2166136261u;
+    for (auto& entry : entries()) {
+        for (char c : entry.tag)
+            hash = (hash ^ uint8_t(c)) * 16777619u;
+        hash = (hash ^ '\n') * 16777619u;
+    }
+    return hash;
+}
+
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+
+/*************************************************************
+ *   EffectRegistry
+ *     tag (as in the eml file, upper case) ==> effect
+ *
+ *   Each effect registers itself in its own .cpp:
+ *     REGISTER_EFFECT("<LAYERSCAN>", LayerScanEffect);
+ *   no other file needs to know it.
+ *
+ *   Ids are the positions of the tags in alphabetical order,
+ *   they are stable as long as the set of effects is the
+ *   same (see hash()).
+*************************************************************/
+class EffectRegistry {
+public:
+    // play(fp, false): only read (check) the parameters
+    // play(fp, true):  read the parameters and show once
+    using Play = bool (*)(FILE* fp, bool show);
+
+    struct Entry {
+        std::string tag;
+        Play play;
+    };
+
+    // called by REGISTER_EFFECT, before main()
+    static bool add(const char* tag, Play play);
+
+    // -1 if unknown
+    static int find(const std::string& tag);
+
+    static int count() { return int(entries().size()); }
+    static const Entry& entry(int id) { return entries()[id]; }
+
+    // FNV-1a of all the tags
+    static uint32_t hash();
+
+private:
+    static std::vector<Entry>& entries();
+};
+
+
+template <typename EffectType>
+bool playEffect(FILE* fp, bool show) {
+    EffectType effect;
+    if (!effect.readFromFP(fp))
+        return false;
+    if (show)
+        effect.showOnce();
+    return true;
+}
+
+#define REGISTER_EFFECT(tag, EffectType) \
+    static bool registered##EffectType = EffectRegistry::add(tag, playEffect<EffectType>)
+
@@ -1,7 +1,10 @@
 #include "fireworks_from_center.h"
+#include "./effect_registry.h"
 #include "../driver/cube_extend.h"
 #include "../utility/image_lib.h"
 
+REGISTER_EFFECT("<FIREWORKSFROMCENTER>", FireworksFromCenterEffect);
+
 
 void FireworksFromCenterEffect::show() {
     for (auto& event : events_) {
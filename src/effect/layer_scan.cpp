@@ -1,8 +1,11 @@
 #include "./layer_scan.h"
+#include "./effect_registry.h"
 #include "../utility/image_lib.h"
 
 extern LedCube cube;
 
+REGISTER_EFFECT("<LAYERSCAN>", LayerScanEffect);
+
 
 void LayerScanEffect::show() {
     for (auto& event : events_) {
@@ -23,10 +26,10 @@ void LayerScanEffect::show(int imageCode, Direction viewDirection, Direction sca
         return;
     }
 
-    LedCube::Array2D_8_8 image;
+    Glyph image;
 
     if (viewDirection == X_ASCEND || viewDirection == X_DESCEND) {
-        cube.getImageInLayerX(image, imageCode, viewDirection, rotate);
+        image = cube.getImageInLayerX(imageCode, viewDirection, rotate, font_);
         if (scanDirection == X_ASCEND) {
             for (int x = 0; x < 7 + together; ++x) {
                 if (x - together > -1)
@@ -49,7 +52,7 @@ void LayerScanEffect::show(int imageCode, Direction viewDirection, Direction sca
         }
     }
     else if (viewDirection == Y_ASCEND || viewDirection == Y_DESCEND) {
-        cube.getImageInLayerY(image, imageCode, viewDirection, rotate);
+        image = cube.getImageInLayerY(imageCode, viewDirection, rotate, font_);
         if (scanDirection == Y_ASCEND) {
             for (int y = 0; y < 7 + together; ++y) {
                 if (y - together > -1)
@@ -72,7 +75,7 @@ void LayerScanEffect::show(int imageCode, Direction viewDirection, Direction sca
         }
     }
     else if (viewDirection == Z_ASCEND || viewDirection == Z_DESCEND) {
-        cube.getImageInLayerZ(image, imageCode, viewDirection, rotate);
+        image = cube.getImageInLayerZ(imageCode, viewDirection, rotate, font_);
         if (scanDirection == Z_ASCEND) {
             for (int z = 0; z < 7 + together; ++z) {
                 if (z - together > -1)
@@ -44,5 +44,6 @@ private:
 protected:
     std::vector<int> imagesCode_;
     std::vector<Event> events_;
+    const Font* font_ = nullptr;        // nullptr: ImageLib only
 };
 
@@ -1,6 +1,9 @@
 #include "random_drop_point.h"
+#include "./effect_registry.h"
 #include "../utility/image_lib.h"
 
+REGISTER_EFFECT("<RANDOMDROPPOINT>", RandomDropPointEffect);
+
 
 void RandomDropPointEffect::show() {
     for (auto& event : events_) {
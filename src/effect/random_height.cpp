@@ -1,4 +1,7 @@
 #include "./random_height.h"
+#include "./effect_registry.h"
+
+REGISTER_EFFECT("<RANDOMHEIGHT>", RandomHeightEffect);
 
 
 void RandomHeightEffect::show() {
@@ -28,12 +31,10 @@ void RandomHeightEffect::show(int together, ShapeType shape, int duration,
     cube.update();
     sleepMs(interval1);
 
-    auto start = std::chrono::system_clock::now();
+    uint64_t start = LedCube::nowUs();
 
     while (1) {
-        auto end = std::chrono::system_clock::now();
-        auto dur = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-        if (dur.count() > duration)
+        if (LedCube::nowUs() - start > uint64_t(duration) * 1000)
             break;
         for (int i = 0; i < together; ++i) {
             int x = randomArray[i] / 8;
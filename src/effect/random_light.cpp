@@ -1,4 +1,5 @@
 #include "random_light.h"
+#include "./effect_registry.h"
 #include "../driver/cube.h"
 #include "../utility/utils.h"
 #include <algorithm>
@@ -7,6 +8,8 @@
 
 extern LedCube cube;
 
+REGISTER_EFFECT("<RANDOMLIGHT>", RandomLightEffect);
+
 
 void RandomLightEffect::show() {
     std::vector<int> randomLeds;
@@ -1,7 +1,10 @@
 #include "./mode_1.h"
+#include "../effect_registry.h"
 #include "../../driver/cube_extend.h"
 #include "../../utility/utils.h"
 
+REGISTER_EFFECT("<RISEANDFALLMODE1>", RiseAndFallMode1Effect);
+
 
 void RiseAndFallMode1Effect::show() {
     for (auto& event : events_) {
@@ -1,7 +1,10 @@
 #include "./mode_2.h"
+#include "../effect_registry.h"
 #include "../../driver/cube_extend.h"
 #include "../../utility/utils.h"
 
+REGISTER_EFFECT("<RISEANDFALLMODE2>", RiseAndFallMode2Effect);
+
 
 void RiseAndFallMode2Effect::rise(int interval) {
     int zs[4] = { 0, 0, 0, 0 };
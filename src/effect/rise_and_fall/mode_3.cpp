@@ -1,8 +1,11 @@
 #include "./mode_3.h"
+#include "../effect_registry.h"
 #include "../../driver/cube_extend.h"
 #include "../../utility/utils.h"
 #include <chrono>
 
+REGISTER_EFFECT("<RISEANDFALLMODE3>", RiseAndFallMode3Effect);
+
 
 void RiseAndFallMode3Effect::show() {
     for (auto& event : events_) {
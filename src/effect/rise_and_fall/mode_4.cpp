@@ -1,8 +1,11 @@
 #include "./mode_4.h"
+#include "../effect_registry.h"
 #include "../../driver/cube_extend.h"
 #include "../../utility/utils.h"
 #include <chrono>
 
+REGISTER_EFFECT("<RISEANDFALLMODE4>", RiseAndFallMode4Effect);
+
 
 void RiseAndFallMode4Effect::show() {
     for (auto& event : events_) {
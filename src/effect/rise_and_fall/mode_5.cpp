@@ -1,8 +1,11 @@
 #include "./mode_5.h"
+#include "../effect_registry.h"
 #include "../../driver/cube_extend.h"
 #include "../../utility/utils.h"
 #include <chrono>
 
+REGISTER_EFFECT("<RISEANDFALLMODE5>", RiseAndFallMode5Effect);
+
 
 void RiseAndFallMode5Effect::show() {
     for (auto& event : events_) {
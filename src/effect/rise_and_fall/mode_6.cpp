@@ -1,8 +1,11 @@
 #include "./mode_6.h"
+#include "../effect_registry.h"
 #include "../../driver/cube_extend.h"
 #include "../../utility/utils.h"
 #include <chrono>
 
+REGISTER_EFFECT("<RISEANDFALLMODE6>", RiseAndFallMode6Effect);
+
 
 void RiseAndFallMode6Effect::showLayerXorYorZ(Layer layer, int count, int interval1, int interval2) {
     Call(cube.clear());
@@ -71,17 +74,14 @@ void RiseAndFallMode6Effect::showLayerXorYorZ(Layer layer, int count, int interv
             if (bOffset) {
                 bOffset = false;
                 if (direction == Z_ASCEND && currZ[0] == 0) {
-                    for (int i = currOffset + 4; i > currOffset; --i) {
-                        cube.copyLayerZ(i - 1, i, true);
-                    }
+                    // only layers currOffset ~ currOffset + 3 are lit
+                    cube.setLeds(cube.getLeds().shiftZ(1));
                     ++currOffset;
                     if (currOffset == 4)
                         direction = Z_DESCEND;
                 }
                 else if (direction == Z_DESCEND && currZ[0] == 7) {
-                    for (int i = currOffset; i < currOffset + 4; ++i) {
-                        cube.copyLayerZ(i, i - 1, true);
-                    }
+                    cube.setLeds(cube.getLeds().shiftZ(-1));
                     --currOffset;
                     if (currOffset == 0)
                         direction = Z_ASCEND;
@@ -173,17 +173,14 @@ void RiseAndFallMode6Effect::showLayerXY(Layer layer, int count, int interval1,
             if (bOffset) {
                 bOffset = false;
                 if (direction == Z_ASCEND && currZ[0] == 0) {
-                    for (int i = currOffset + 4; i > currOffset; --i) {
-                        cube.copyLayerZ(i - 1, i, true);
-                    }
+                    // only layers currOffset ~ currOffset + 3 are lit
+                    cube.setLeds(cube.getLeds().shiftZ(1));
                     ++currOffset;
                     if (currOffset == 4)
                         direction = Z_DESCEND;
                 }
                 else if (direction == Z_DESCEND && currZ[0] == 14) {
-                    for (int i = currOffset; i < currOffset + 4; ++i) {
-                        cube.copyLayerZ(i, i - 1, true);
-                    }
+                    cube.setLeds(cube.getLeds().shiftZ(-1));
                     --currOffset;
                     if (currOffset == 0)
                         direction = Z_ASCEND;
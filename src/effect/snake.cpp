@@ -1,6 +1,9 @@
 #include "./snake.h"
+#include "./effect_registry.h"
 #include "../utility/snake.h"
 
+REGISTER_EFFECT("<SNAKE>", SnakeEffect);
+
 
 void SnakeEffect::show() {
     for (auto& event : events_) {
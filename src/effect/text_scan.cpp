@@ -1,16 +1,19 @@
 #include "./text_scan.h"
-#include "../utility/image_lib.h"
+#include "./effect_registry.h"
+#include "../utility/font.h"
+
+REGISTER_EFFECT("<TEXTSCAN>", TextScanEffect);
 
 
 void TextScanEffect::setText(std::string text) {
-    ImageLib::validate(text);
-    int len = text.length();
-    std::vector<int> imagesCode;
-    imagesCode.reserve(len);
-    for (int i = 0; i < len; ++i) {
-        imagesCode.push_back(int(text[i]));
-    }
-    this->setImagesCode(imagesCode);
+    this->setImagesCode(Font::toImagesCode(text, font_));
+    text_ = std::move(text);
+}
+
+void TextScanEffect::setFont(const Font* font) {
+    font_ = font;
+    if (!text_.empty())
+        this->setText(text_);
 }
 
 
@@ -38,6 +41,13 @@ bool TextScanEffect::readFromFP(FILE* fp) {
                 }
             }
         }
+        else if (strcmp(tag1, "<FONT>") == 0) {
+            char font[256] = { 0 };
+            fscanf(fp, "%255s", font);
+            this->setFont(Font::findOrLoad(font));
+            if (!font_)
+                printf("Can't find font %s\n", font);
+        }
         else if (strcmp(tag1, "<EVENTS>") == 0) {
             while (true) {
                 char tag2[32] = { 0 };
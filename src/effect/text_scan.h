@@ -5,7 +5,12 @@
 class TextScanEffect : public LayerScanEffect {
 public:
     void setText(std::string text);     // not use const reference
+    // nullptr: ImageLib only (the text is upper-cased)
+    void setFont(const Font* font);
 
     virtual bool readFromFP(FILE* fp);
+
+private:
+    std::string text_;
 };
 
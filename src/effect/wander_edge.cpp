@@ -1,6 +1,9 @@
 #include "./wander_edge.h"
+#include "./effect_registry.h"
 #include "../utility/snake.h"
 
+REGISTER_EFFECT("<WANDEREDGE>", WanderEdgeEffect);
+
 
 void WanderEdgeEffect::show() {
     for (auto& event: events_) {
@@ -1,6 +1,9 @@
 #include "./wander_edge_join.h"
+#include "./effect_registry.h"
 #include "../utility/snake.h"
 
+REGISTER_EFFECT("<WANDEREDGEJOIN>", WanderEdgeJoinEffect);
+
 
 void WanderEdgeJoinEffect::show() {
     for (auto& event: events_) {
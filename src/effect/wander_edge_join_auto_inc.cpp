@@ -1,6 +1,9 @@
 #include "./wander_edge_join_auto_inc.h"
+#include "./effect_registry.h"
 #include "../utility/snake.h"
 
+REGISTER_EFFECT("<WANDEREDGEJOINAUTOINC>", WanderEdgeJoinAutoIncEffect);
+
 
 void WanderEdgeJoinAutoIncEffect::show() {
     for (auto& event: events_) {
@@ -1,6 +1,9 @@
 #include "driver/cube.h"
 #include "driver/cube_extend.h"
-#include "driver/script.h"
+#include "driver/eml_program.h"
+#include "driver/refresh_stats.h"
+#include "utility/font.h"
+#include "utility/line_cache.h"
 #include "utility/image_lib.h"
 #include "utility/utils.h"
 #include <cstdio>
@@ -8,42 +11,14 @@
 #include <cstring>
 #include <thread>
 #include <chrono>
+#include <string>
+#include <vector>
 #include <iostream>
 #include <fstream>
-#include <wiringPi.h>
 #include <time.h>
 #include <signal.h>
 #include <unistd.h>
 
-/**********************************************
- *
- *   Effects
- *
-**********************************************/
-#include "effect/layer_scan.h"
-#include "effect/random_light.h"
-#include "effect/layer_scan.h"
-#include "effect/drop_line.h"
-#include "effect/drop_point.h"
-#include "effect/random_drop_point.h"
-#include "effect/drop_text_point.h"
-#include "effect/text_scan.h"
-#include "effect/cube_size_from_vertex.h"
-#include "effect/cube_size_from_inner.h"
-#include "effect/rise_and_fall/mode_1.h"
-#include "effect/rise_and_fall/mode_2.h"
-#include "effect/rise_and_fall/mode_3.h"
-#include "effect/rise_and_fall/mode_4.h"
-#include "effect/rise_and_fall/mode_5.h"
-#include "effect/rise_and_fall/mode_6.h"
-#include "effect/snake.h"
-#include "effect/random_height.h"
-#include "effect/fireworks_from_center.h"
-#include "effect/breath_cube.h"
-#include "effect/wander_edge.h"
-#include "effect/wander_edge_join.h"
-#include "effect/wander_edge_join_auto_inc.h"
-
 LedCube cube;
 
 
@@ -53,48 +28,164 @@ void sleepMs(int ms) {
 
 void printUsage() {
     printf("Usage: \n");
-    printf("  ./led_cube run [effect_description_file]\n");
-    printf("  ./led_cube off\n");
+    printf("  ./led_cube [options] run [effect_description_file]\n");
+    printf("  ./led_cube [options] play [animation_file]\n");
+    printf("  ./led_cube [options] off\n");
+    printf("Options: \n");
+    printf("  --backend=NAME   wiringpi, gpiomem, sim or sim:<dump_file> (default: %s)\n",
+            defaultBackendName());
+    printf("  --cpu=N          pin the refresh thread to core N\n");
+    printf("  --rt-priority=N  run the refresh thread with SCHED_FIFO priority N (1 ~ 99)\n");
+    printf("  --mlock          lock all the memory (no page faults while refreshing)\n");
+    printf("  --prerender      render each effect ahead of time, then play it\n");
+    printf("  --record=FILE    record the effects run to FILE (run only, see play)\n");
+    printf("  --font=FILE      load a font pack (<FONT> its name in TextScan/DropTextPoint)\n");
+    printf("  --line-cache     precompute every line between two LEDs (16 MB)\n");
+    printf("  --stats=FILE     write the refresh stats to FILE at exit\n");
+    printf("                   (kill -USR1 <pid> prints them at any time)\n");
 }
 
-void catchCtrlC(int) {
+std::string statsFile;
+std::string recordFile;
+bool prerender = false;
+AnimationWriter recorder;
+
+void dumpStats() {
+    if (!statsFile.empty() && !RefreshStats::dumpToFile(statsFile.c_str()))
+        printf("Can't write stats to %s\n", statsFile.c_str());
+}
+
+void stopRecording() {
+    if (!recorder.isOpen())
+        return;
+    LedCube::setRecorder(nullptr);
+    if (recorder.close())
+        printf("%u frames recorded\n", recorder.frameCount());
+    else
+        printf("Failed to write the record\n");
+}
+
+// on the main thread, at the first update() / sleep after Ctrl+C
+void stopOnCtrlC() {
     printf("\nCatch Ctrl+C!\n");
+    stopRecording();
     LedCube::quit();
+    dumpStats();
     exit(1);
 }
 
+void catchCtrlC(int) {
+    LedCube::requestStop();
+}
+
+void catchUsr1(int) {
+    RefreshStats::requestDump();
+}
+
 int run(const char* effectDescFile);
+int play(const char* animationFile);
 
 
 int main(int argc, char** argv) {
-    if (argc < 2) {
+    // split options (--xxx) and arguments
+    std::string backendName = defaultBackendName();
+    RefreshOptions refreshOptions;
+    std::vector<char*> args;
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--backend=", 10) == 0) {
+            backendName = argv[i] + 10;
+        }
+        else if (strncmp(argv[i], "--cpu=", 6) == 0) {
+            refreshOptions.cpu = atoi(argv[i] + 6);
+        }
+        else if (strncmp(argv[i], "--rt-priority=", 14) == 0) {
+            refreshOptions.priority = atoi(argv[i] + 14);
+        }
+        else if (strcmp(argv[i], "--mlock") == 0) {
+            refreshOptions.lockMemory = true;
+        }
+        else if (strncmp(argv[i], "--record=", 9) == 0) {
+            recordFile = argv[i] + 9;
+        }
+        else if (strcmp(argv[i], "--prerender") == 0) {
+            prerender = true;
+        }
+        else if (strncmp(argv[i], "--font=", 7) == 0) {
+            if (!Font::load(argv[i] + 7)) {
+                printf("Can't load font %s\n", argv[i] + 7);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--line-cache") == 0) {
+            LineCache::enable();
+        }
+        else if (strncmp(argv[i], "--stats=", 8) == 0) {
+            statsFile = argv[i] + 8;
+        }
+        else if (strncmp(argv[i], "--", 2) == 0) {
+            printUsage();
+            return 1;
+        }
+        else {
+            args.push_back(argv[i]);
+        }
+    }
+
+    if (args.empty()) {
         printUsage();
         return 1;
     }
 
-    if (wiringPiSetupGpio() == -1) {
-        printf("Wiringpi setup failed\n");
+    // the file is opened (truncated) by run() only
+    if (!recordFile.empty() && strcmp(args[0], "run") != 0) {
+        printf("--record only works with run\n");
+        return 1;
+    }
+
+    CubeBackend* backend = createBackend(backendName);
+    if (!backend) {
+        printf("Unknown backend: %s\n", backendName.c_str());
         return 1;
     }
 
     srand(time(NULL));
+    LedCube::setStopHandler(stopOnCtrlC);
     signal(SIGINT, catchCtrlC);
+    signal(SIGUSR1, catchUsr1);
 
-    // must setup after wiringPiSetupGpio() !
-    cube.setup();
+    if (!cube.setup(backend, refreshOptions)) {
+        printf("Backend %s setup failed\n", backendName.c_str());
+        return 1;
+    }
 
-    sleepMs(5000);
+    // wait for the hardware (the simulator doesn't need it)
+    if (backend->needScan())
+        sleepMs(5000);
 
-    if (strcmp(argv[1], "run" ) == 0) {
-        if (argc != 3) {
+    if (strcmp(args[0], "run" ) == 0) {
+        if (args.size() != 2) {
             printUsage();
             return 1;
         }
         else {
-            return run(argv[2]);
+            int ret = run(args[1]);
+            stopRecording();
+            dumpStats();
+            return ret;
         }
     }
-    else if (strcmp(argv[1], "off") == 0) {
+    else if (strcmp(args[0], "play") == 0) {
+        if (args.size() != 2) {
+            printUsage();
+            return 1;
+        }
+        else {
+            int ret = play(args[1]);
+            dumpStats();
+            return ret;
+        }
+    }
+    else if (strcmp(args[0], "off") == 0) {
         Call(cube.clear());
         return 0;
     }
@@ -105,354 +196,33 @@ int main(int argc, char** argv) {
 
 
 int run(const char* effectDescFile) {
-    // 1. remove annotation
-    std::ifstream ifs(effectDescFile);
-    if (!ifs.is_open())
+    // parsed once (or loaded from its cache), then played
+    EmlProgram program;
+    if (!program.load(effectDescFile))
         return 1;
 
-    struct timespec tn;
-    clock_gettime(CLOCK_REALTIME, &tn);
-
-    char cacheFile[32] = { 0 };
-    sprintf(cacheFile, "%d", tn.tv_nsec);
-
-    std::ofstream ofs(cacheFile);
-    if (!ofs.is_open()) {
-        ifs.close();
-        return 1;
-    }
-
-    std::string line;
-    bool isCommenting = false;
-    while (getline(ifs, line)) {
-        util::trim(line);
-        if (line.empty())
-            continue;
-        if (isCommenting) {
-            if (line == "<END_COMMENT>")
-                isCommenting = false;
-            continue;
-        }
-        if (line == "<COMMENT>")
-            isCommenting = true;
-        else if (line == "<END><END>") {
-            ofs << line << std::endl;
-            break;
-        }
-        else if (line.substr(0, 2) != "<#") {
-            ofs << line << std::endl;
+    // opened (truncated) once there is something to record
+    if (!recordFile.empty()) {
+        if (!recorder.open(recordFile)) {
+            printf("Can't write %s\n", recordFile.c_str());
+            return 1;
         }
+        LedCube::setRecorder(&recorder);
     }
-    ifs.close();
-    ofs.close();
+    return program.run(prerender) ? 0 : 1;
+}
 
-    // 2. parse file
-    FILE* fp = fopen(cacheFile, "r");
-    if (!fp)
+int play(const char* animationFile) {
+    AnimationReader reader;
+    if (!reader.open(animationFile)) {
+        printf("Can't read %s\n", animationFile);
         return 1;
+    }
 
-    bool ret = 0;
-
-    do {
-        while (!feof(fp)) {
-            char tag[32] = { 0 };     
-            fscanf(fp, "%s", tag);
-            util::toUpperCase(tag, strlen(tag));
-            if (strcmp(tag, "<CUBESIZEFROMVERTEX>") == 0) {
-                CubeSizeFromVertexEffect cubeSizeFromVertex;
-                if (cubeSizeFromVertex.readFromFP(fp))
-                    cubeSizeFromVertex.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<CUBESIZEFROMINNER>") == 0) { CubeSizeFromInnerEffect cubeSizeFromInner; if (cubeSizeFromInner.readFromFP(fp))
-                    cubeSizeFromInner.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<DROPLINE>") == 0) {
-                DropLineEffect dropLine;
-                if (dropLine.readFromFP(fp))
-                    dropLine.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<DROPPOINT>") == 0) {
-                DropPointEffect dropPoint;
-                if (dropPoint.readFromFP(fp))
-                    dropPoint.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<DROPTEXTPOINT>") == 0) {
-                DropTextPointEffect dropTextPoint;
-                if (dropTextPoint.readFromFP(fp))
-                    dropTextPoint.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<LAYERSCAN>") == 0) {
-                LayerScanEffect layerScan;
-                if (layerScan.readFromFP(fp))
-                    layerScan.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<RANDOMDROPPOINT>") == 0) {
-                RandomDropPointEffect randomDropPoint;
-                if (randomDropPoint.readFromFP(fp))
-                    randomDropPoint.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<RANDOMLIGHT>") == 0) {
-                RandomLightEffect randomLight;
-                if (randomLight.readFromFP(fp))
-                    randomLight.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<TEXTSCAN>") == 0) {
-                TextScanEffect textScan;
-                if (textScan.readFromFP(fp))
-                    textScan.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<SNAKE>") == 0) {
-                SnakeEffect snake;
-                if (snake.readFromFP(fp))
-                    snake.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<RANDOMHEIGHT>") == 0) {
-                RandomHeightEffect randomHeight;
-                if (randomHeight.readFromFP(fp))
-                    randomHeight.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<FIREWORKSFROMCENTER>") == 0) {
-                FireworksFromCenterEffect fireworksFromCenter;
-                if (fireworksFromCenter.readFromFP(fp))
-                    fireworksFromCenter.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<RISEANDFALLMODE1>") == 0) {
-                RiseAndFallMode1Effect riseAndFallMode1;
-                if (riseAndFallMode1.readFromFP(fp))
-                    riseAndFallMode1.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<RISEANDFALLMODE2>") == 0) {
-                RiseAndFallMode2Effect riseAndFallMode2;
-                if (riseAndFallMode2.readFromFP(fp))
-                    riseAndFallMode2.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<RISEANDFALLMODE3>") == 0) {
-                RiseAndFallMode3Effect riseAndFallMode3;
-                if (riseAndFallMode3.readFromFP(fp))
-                    riseAndFallMode3.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<RISEANDFALLMODE4>") == 0) {
-                RiseAndFallMode4Effect riseAndFallMode4;
-                if (riseAndFallMode4.readFromFP(fp))
-                    riseAndFallMode4.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<RISEANDFALLMODE5>") == 0) {
-                RiseAndFallMode5Effect riseAndFallMode5;
-                if (riseAndFallMode5.readFromFP(fp))
-                    riseAndFallMode5.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<RISEANDFALLMODE6>") == 0) {
-                RiseAndFallMode6Effect riseAndFallMode6;
-                if (riseAndFallMode6.readFromFP(fp))
-                    riseAndFallMode6.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<WANDEREDGE>") == 0) {
-                WanderEdgeEffect wanderEdge;
-                if (wanderEdge.readFromFP(fp))
-                    wanderEdge.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<WANDEREDGEJOIN>") == 0) {
-                WanderEdgeJoinEffect wanderEdgeJoin;
-                if (wanderEdgeJoin.readFromFP(fp))
-                    wanderEdgeJoin.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<WANDEREDGEJOINAUTOINC>") == 0) {
-                WanderEdgeJoinAutoIncEffect wanderEdgeJoinAutoInc;
-                if (wanderEdgeJoinAutoInc.readFromFP(fp))
-                    wanderEdgeJoinAutoInc.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<BREATHCUBE>") == 0) {
-                BreathCubeEffect breathCube;
-                if (breathCube.readFromFP(fp))
-                    breathCube.showOnce();
-                else {
-                    ret = 1;
-                    break;
-                }
-            }
-
-
-            else if (strcmp(tag, "<SCRIPT>") == 0) {
-                bool bBreak = false;;
-                while (true) {
-                    char tag1[32] = { 0 };
-                    fscanf(fp, "%s", tag1);
-                    util::toUpperCase(tag1, strlen(tag1));
-                    if (strcmp(tag1, "<FILE>") == 0) {
-                        char filename[64] = { 0 };
-                        fscanf(fp, "%s", filename);
-                        Script script;
-                        script.run(filename);
-                    }
-                    else if (strcmp(tag1, "<END>") == 0) {
-                        break;
-                    }
-                    else {
-                        bBreak = true;
-                        break;
-                    }
-                }
-                if (bBreak) {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<EML>") == 0) {
-                bool bBreak = false;;
-                while (true) {
-                    char tag1[32] = { 0 };
-                    fscanf(fp, "%s", tag1);
-                    util::toUpperCase(tag1, strlen(tag1));
-                    if (strcmp(tag1, "<FILE>") == 0) {
-                        char filename[256] = { 0 };
-                        fscanf(fp, "%s", filename);
-                        if (run(filename) != 0) {
-                            bBreak = true;
-                            break;
-                        }
-                    }
-                    else if (strcmp(tag1, "<END>") == 0) {
-                        break;
-                    }
-                    else {
-                        bBreak = true;
-                        break;
-                    }
-                }
-                if (bBreak) {
-                    ret = 1;
-                    break;
-                }
-            }
-
-            else if (strcmp(tag, "<END><END>") == 0) {
-                ret = 0;
-                break;
-            }
-
-            else if (strcmp(tag, "") == 0) {
-                printf("[Warning] missing <END><END> in the end of the eml-file.\n");
-                ret = 0;
-                break;
-            }
-
-            else {
-                ret = 1;
-                printf("Unknown tag: %s\n", tag);
-                break;
-            }
-        }
-    } while(false);
-
-    fclose(fp);
-    remove(cacheFile);
-    return ret;
+    FramePlayer player;
+    TimedFrame frame;
+    while (reader.next(frame))
+        player.present(frame);
+    return 0;
 }
 
-
@@ -1,6 +1,9 @@
 #include "ExpressionEvaluator.h"
 
 #include <cmath>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
 #include <sstream>
 #include <stack>
 #include <algorithm>
@@ -264,6 +267,391 @@ double ExpressionEvaluator::evalRPN(std::vector<std::string>& tokens) {
         return nums.top();
 }
 
+/*************************************************
+ *
+ *  Compiled expression
+ *    parsed once to RPN instructions, the levels
+ *    of priority(): 3 (+ -), 2 (* / %), 1 (^),
+ *    then '-' (negative), numbers, x y z t pi,
+ *    functions sin(...), (...)
+ *
+*************************************************/
+static void skipSpaces(const char*& p) {
+    while (*p == ' ')
+        ++p;
+}
+
+// after a complete operand
+static int unexpected(char c) {
+    bool operand = (c >= '0' && c <= '9') || c == '.' || c == '(' || isalpha((unsigned char)c);
+    return operand ? 0x08 : 0x03;   // missing operator, unknown character
+}
+
+static double apply(char op, double left, double right) {
+    switch (op) {
+    case '+': return left + right;
+    case '-': return left - right;
+    case '*': return left * right;
+    case '/': return left / right;
+    case '%': return int(right) != 0 ? int(left) % int(right) : NAN;
+    case '^': return pow(left, right);
+    default:  return 0;
+    }
+}
+
+static const char BinaryOperators[] = "+-*/%^";    // in the order of OP_ADD ...
+
+template <typename T>
+T ExpressionEvaluator::applyFunction(OpCode op, T value) {
+    switch (op) {
+    case OP_NEG:  return -value;
+    case OP_SIN:  return std::sin(value);
+    case OP_COS:  return std::cos(value);
+    case OP_TAN:  return std::tan(value);
+    case OP_SQRT: return std::sqrt(value);
+    case OP_ABS:  return std::abs(value);
+    case OP_EXP:  return std::exp(value);
+    case OP_LOG:  return std::log(value);
+    default:      return 0;
+    }
+}
+
+bool ExpressionEvaluator::compile(const std::string& str) {
+    errorCode = 0;
+    stdExp = str;
+    code.clear();
+    depth = 0;
+    maxDepth = 0;
+
+    const char* p = str.c_str();
+    skipSpaces(p);
+    if (*p == '\0') {
+        errorCode = 0x06;
+        return false;
+    }
+    if (isOperator(*p) && *p != '-') {
+        errorCode = 0x04;
+        return false;
+    }
+
+    if (compileLevel(p, 3)) {
+        skipSpaces(p);
+        if (*p == ')')
+            errorCode = 0x07;
+        else if (*p != '\0')
+            errorCode = unexpected(*p);
+        else if (maxDepth > MaxStack)
+            errorCode = 0x09;
+    }
+
+    if (errorCode != 0) {
+        code.clear();
+        return false;
+    }
+    return true;
+}
+
+bool ExpressionEvaluator::compileLevel(const char*& p, int level) {
+    if (!compileOperandOf(p, level, false))
+        return false;
+
+    while (true) {
+        skipSpaces(p);
+        char op = *p;
+        if (!isOperator(op) || priority(op) != level)
+            return true;
+        ++p;
+        if (!compileOperandOf(p, level, true))
+            return false;
+        emit(OpCode(OP_ADD + (strchr(BinaryOperators, op) - BinaryOperators)));
+    }
+}
+
+// -2^2 == -(2^2), 2^-1 == 0.5
+bool ExpressionEvaluator::compileOperandOf(const char*& p, int level, bool right) {
+    if (level == 1)
+        return right ? compileUnary(p, true) : compileOperand(p);
+    if (level == 2)
+        return compileUnary(p, false);
+    return compileLevel(p, level - 1);
+}
+
+// '-' of an operand, or of a power
+bool ExpressionEvaluator::compileUnary(const char*& p, bool operand) {
+    skipSpaces(p);
+    if (*p != '-')
+        return operand ? compileOperand(p) : compileLevel(p, 1);
+
+    ++p;
+    if (!compileUnary(p, operand))
+        return false;
+    emit(OP_NEG);
+    return true;
+}
+
+bool ExpressionEvaluator::compileOperand(const char*& p) {
+    skipSpaces(p);
+    char c = *p;
+
+    if (isPartOfNumber(c)) {
+        char number[64] = { 0 };
+        size_t len = 0;
+        while (isPartOfNumber(p[len]) && len < sizeof(number) - 1) {
+            number[len] = p[len];
+            ++len;
+        }
+        char* end;
+        double value = strtod(number, &end);
+        if (end != number + len) {
+            errorCode = 0x03;       // "1.2.3"
+            return false;
+        }
+        emit(OP_CONST, value);
+        p += len;
+        return true;
+    }
+
+    if (isalpha((unsigned char)c))
+        return compileName(p);
+
+    switch (c) {
+    case '(':
+        ++p;
+        if (!compileLevel(p, 3))
+            return false;
+        skipSpaces(p);
+        if (*p != ')') {
+            errorCode = (*p == '\0') ? 0x07 : unexpected(*p);
+            return false;
+        }
+        ++p;
+        return true;
+    case ')':
+        errorCode = 0x07;
+        return false;
+    case '\0':
+        errorCode = 0x05;
+        return false;
+    default:
+        errorCode = isOperator(c) ? 0x02 : 0x03;
+        return false;
+    }
+}
+
+// a variable, pi, or a function and its (...)
+bool ExpressionEvaluator::compileName(const char*& p) {
+    static const struct {
+        const char* name;
+        OpCode op;
+    } names[] = {
+        { "x", OP_X }, { "y", OP_Y }, { "z", OP_Z }, { "t", OP_T },
+        { "sin", OP_SIN }, { "cos", OP_COS }, { "tan", OP_TAN }, { "sqrt", OP_SQRT },
+        { "abs", OP_ABS }, { "exp", OP_EXP }, { "log", OP_LOG },
+    };
+
+    char name[8] = { 0 };
+    size_t len = 0;
+    while (isalpha((unsigned char)p[len])) {
+        if (len < sizeof(name) - 1)
+            name[len] = tolower((unsigned char)p[len]);
+        ++len;
+    }
+    if (len < sizeof(name) && strcmp(name, "pi") == 0) {
+        emit(OP_CONST, M_PI);
+        p += len;
+        return true;
+    }
+
+    for (const auto& entry : names) {
+        if (len >= sizeof(name) || strcmp(name, entry.name) != 0)
+            continue;
+        p += len;
+        if (entry.op <= OP_T) {
+            emit(entry.op);
+            return true;
+        }
+        skipSpaces(p);
+        if (*p != '(') {
+            errorCode = 0x0A;       // "sin x"
+            return false;
+        }
+        if (!compileOperand(p))
+            return false;
+        emit(entry.op);
+        return true;
+    }
+
+    errorCode = 0x0A;
+    return false;
+}
+
+void ExpressionEvaluator::emit(OpCode op, double value) {
+    if (op <= OP_T)
+        maxDepth = std::max(maxDepth, ++depth);
+    else if (op >= OP_ADD)
+        --depth;
+
+    // fold constants:  -(2)  ==> -2,  cos(0) ==> 1,  2*3 ==> 6
+    size_t n = code.size();
+    if (op > OP_T && op < OP_ADD && n >= 1 && code[n - 1].op == OP_CONST) {
+        code[n - 1].value = applyFunction(op, code[n - 1].value);
+        return;
+    }
+    if (op >= OP_ADD && n >= 2 && code[n - 1].op == OP_CONST && code[n - 2].op == OP_CONST) {
+        code[n - 2].value = apply(BinaryOperators[op - OP_ADD], code[n - 2].value, code[n - 1].value);
+        code.pop_back();
+        return;
+    }
+
+    code.push_back(Instruction{ op, value });
+}
+
+double ExpressionEvaluator::eval(double x, double y, double z, double t) const {
+    double stack[MaxStack];
+    int top = -1;
+    for (const Instruction& ins : code) {
+        switch (ins.op) {
+        case OP_CONST: stack[++top] = ins.value; break;
+        case OP_X:     stack[++top] = x; break;
+        case OP_Y:     stack[++top] = y; break;
+        case OP_Z:     stack[++top] = z; break;
+        case OP_T:     stack[++top] = t; break;
+        case OP_NEG:   stack[top] = -stack[top]; break;
+        case OP_ADD:   --top; stack[top] += stack[top + 1]; break;
+        case OP_SUB:   --top; stack[top] -= stack[top + 1]; break;
+        case OP_MUL:   --top; stack[top] *= stack[top + 1]; break;
+        case OP_DIV:   --top; stack[top] /= stack[top + 1]; break;
+        case OP_MOD:
+        case OP_POW:
+            --top;
+            stack[top] = apply(BinaryOperators[ins.op - OP_ADD], stack[top], stack[top + 1]);
+            break;
+        default:
+            stack[top] = applyFunction(ins.op, stack[top]);
+            break;
+        }
+    }
+    return top >= 0 ? stack[top] : 0;
+}
+
+
+/*************************************************
+ *
+ *  Batch
+ *    one instruction at a time over a block of
+ *    64 values, the + - * / in SIMD lanes, the
+ *    functions lane by lane
+ *
+*************************************************/
+ExpressionEvaluator::Lanes ExpressionEvaluator::splat(float value) {
+    Lanes lanes = { value, value, value, value };
+    return lanes;
+}
+
+void ExpressionEvaluator::evalBlock(const Lanes x[], const Lanes y[], const Lanes z[], float t, Lanes out[]) const {
+    Lanes stack[MaxStack][BlockVectors];
+    int top = -1;
+    for (const Instruction& ins : code) {
+        switch (ins.op) {
+        case OP_CONST:
+            ++top;
+            for (int v = 0; v < BlockVectors; ++v)
+                stack[top][v] = splat(float(ins.value));
+            break;
+        case OP_X: ++top; std::copy(x, x + BlockVectors, stack[top]); break;
+        case OP_Y: ++top; std::copy(y, y + BlockVectors, stack[top]); break;
+        case OP_Z: ++top; std::copy(z, z + BlockVectors, stack[top]); break;
+        case OP_T:
+            ++top;
+            for (int v = 0; v < BlockVectors; ++v)
+                stack[top][v] = splat(t);
+            break;
+        case OP_NEG:
+            for (int v = 0; v < BlockVectors; ++v)
+                stack[top][v] = -stack[top][v];
+            break;
+        case OP_ADD:
+            --top;
+            for (int v = 0; v < BlockVectors; ++v)
+                stack[top][v] += stack[top + 1][v];
+            break;
+        case OP_SUB:
+            --top;
+            for (int v = 0; v < BlockVectors; ++v)
+                stack[top][v] -= stack[top + 1][v];
+            break;
+        case OP_MUL:
+            --top;
+            for (int v = 0; v < BlockVectors; ++v)
+                stack[top][v] *= stack[top + 1][v];
+            break;
+        case OP_DIV:
+            --top;
+            for (int v = 0; v < BlockVectors; ++v)
+                stack[top][v] /= stack[top + 1][v];
+            break;
+        case OP_MOD:
+        case OP_POW:
+            --top;
+            for (int v = 0; v < BlockVectors; ++v) {
+                for (int l = 0; l < LaneCount; ++l)
+                    stack[top][v][l] = float(apply(BinaryOperators[ins.op - OP_ADD], stack[top][v][l], stack[top + 1][v][l]));
+            }
+            break;
+        default:
+            for (int v = 0; v < BlockVectors; ++v) {
+                for (int l = 0; l < LaneCount; ++l)
+                    stack[top][v][l] = applyFunction(ins.op, float(stack[top][v][l]));
+            }
+            break;
+        }
+    }
+
+    for (int v = 0; v < BlockVectors; ++v)
+        out[v] = top >= 0 ? stack[top][v] : splat(0);
+}
+
+void ExpressionEvaluator::evalBatch(const float* x, const float* y, const float* z, float t, float* out, size_t n) const {
+    for (size_t base = 0; base < n; base += BlockSize) {
+        size_t bytes = std::min(n - base, size_t(BlockSize)) * sizeof(float);
+        Lanes bx[BlockVectors] = {}, by[BlockVectors] = {}, bz[BlockVectors] = {};
+        Lanes result[BlockVectors];
+        memcpy(bx, x + base, bytes);
+        memcpy(by, y + base, bytes);
+        memcpy(bz, z + base, bytes);
+        evalBlock(bx, by, bz, t, result);
+        memcpy(out + base, result, bytes);
+    }
+}
+
+void ExpressionEvaluator::evalGrid(double t, uint64_t layers[8]) const {
+    static_assert(BlockSize == 64, "a block is a layer");
+
+    // layer z: value v * 4 + l of the block is (x, y) = bit x * 8 + y
+    Lanes x[BlockVectors], y[BlockVectors], z[BlockVectors], result[BlockVectors];
+    for (int v = 0; v < BlockVectors; ++v) {
+        x[v] = splat(float(v / 2));
+        for (int l = 0; l < LaneCount; ++l)
+            y[v][l] = float(v % 2 * 4 + l);
+    }
+
+    const Lanes low = splat(-0.5f), high = splat(0.5f);
+    for (int layer = 0; layer < 8; ++layer) {
+        for (int v = 0; v < BlockVectors; ++v)
+            z[v] = splat(float(layer));
+        evalBlock(x, y, z, float(t), result);
+
+        uint64_t bits = 0;
+        for (int v = 0; v < BlockVectors; ++v) {
+            auto on = (result[v] > low) & (result[v] < high);   // -1 or 0
+            for (int l = 0; l < LaneCount; ++l)
+                bits |= uint64_t(on[l] & 1) << (v * 4 + l);
+        }
+        layers[layer] = bits;
+    }
+}
+
+
 bool ExpressionEvaluator::isPartOfNumber(char c) {
     return  (c >= '0' && c <= '9') || c == '.';
 }
@@ -336,6 +724,12 @@ std::string ExpressionEvaluator::getErrorDesc(int err_code) {
         return "ERROR: Empty expression";
     case 0x07:
         return "ERROR: Unmatched parentheses";
+    case 0x08:
+        return "ERROR: Missing operator";
+    case 0x09:
+        return "ERROR: Expression too complex";
+    case 0x0A:
+        return "ERROR: Unknown function or variable";
     default:
         return "Unknown error";
     }
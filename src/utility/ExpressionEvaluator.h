@@ -7,6 +7,8 @@
 #ifndef __EXPRESSION_EVALUATOR_H__
 #define __EXPRESSION_EVALUATOR_H__
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -17,6 +19,30 @@ public:
 
     double eval(const std::string& str);
 
+    /*************************************************
+     *  Compiled expression, with variables x, y, z, t
+     *  and functions sin cos tan sqrt abs exp log, pi
+     *    compile() once (false on error, see
+     *    getLastError()), then eval() as many times
+     *    as needed: it allocates nothing
+     *  e.g.  compile("x*x + y - 2*z");
+     *        eval(1, 2, 3);
+    *************************************************/
+    bool compile(const std::string& str);
+    double eval(double x, double y, double z, double t = 0) const;
+
+    /*************************************************
+     *  Batch of the compiled expression, in float
+     *  SIMD lanes (may differ from eval() in the
+     *  last bits)
+     *    evalBatch(): out[i] of (x[i], y[i], z[i])
+     *    evalGrid():  the 512 LEDs of the cube,
+     *      bit (x * 8 + y) of layers[z] set where
+     *      the value is about 0 (-0.5 < value < 0.5)
+    *************************************************/
+    void evalBatch(const float* x, const float* y, const float* z, float t, float* out, size_t n) const;
+    void evalGrid(double t, uint64_t layers[8]) const;
+
     int getLastError() { return errorCode; }
     std::string getErrorDesc(int err_code = -1);
 
@@ -37,10 +63,46 @@ private:
 
     bool toNumber(const std::string& str, double& val);
 
+    /*************************
+     *  compile
+    *************************/
+    enum OpCode {
+        OP_CONST, OP_X, OP_Y, OP_Z, OP_T,
+        OP_NEG, OP_SIN, OP_COS, OP_TAN, OP_SQRT, OP_ABS, OP_EXP, OP_LOG,
+        OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_MOD, OP_POW
+    };
+    struct Instruction {
+        OpCode op;
+        double value;   // OP_CONST
+    };
+    enum { MaxStack = 32 };
+
+    // 4 floats, a NEON / SSE register (GCC vector extension),
+    // a block is BlockVectors of them
+    typedef float Lanes __attribute__((vector_size(16)));
+    enum { LaneCount = 4, BlockVectors = 16, BlockSize = LaneCount * BlockVectors };
+
+    // one level of priority(), left-associative
+    bool compileLevel(const char*& p, int level);
+    bool compileOperandOf(const char*& p, int level, bool right);
+    bool compileUnary(const char*& p, bool operand);
+    bool compileOperand(const char*& p);
+    bool compileName(const char*& p);
+    void emit(OpCode op, double value = 0);
+
+    template <typename T>
+    static T applyFunction(OpCode op, T value);     // OP_NEG ~ OP_LOG
+    static Lanes splat(float value);
+    void evalBlock(const Lanes x[], const Lanes y[], const Lanes z[], float t, Lanes out[]) const;
+
 private:
     int errorCode = 0;
     std::string stdExp; // standardized expression;
     std::vector<std::string> rpn;
+
+    std::vector<Instruction> code;  // compiled RPN
+    int depth = 0;                  // of the stack, while compiling
+    int maxDepth = 0;
 };
 
 #endif //__EXPRESSION_EVALUATOR_H__
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+
+
+/*************************************************************
+ *   Busy-wait delays in nanoseconds
+ *
+ *   sleep_for() / nanosleep() can't sleep less than ~50us,
+ *   so short delays have to spin. An empty for loop is
+ *   removed by the compiler (-O2, -O3) and its duration
+ *   changes from board to board (3B, 4B ...), so:
+ *
+ *     - short delays spin a loop the compiler can't remove,
+ *       calibrated against CLOCK_MONOTONIC_RAW by calibrate()
+ *     - long delays spin on CLOCK_MONOTONIC_RAW itself
+*************************************************************/
+namespace util {
+
+class SpinDelay {
+public:
+    // measure the speed of the spin loop (takes a few milliseconds)
+    static void calibrate();
+
+    static void spinNs(uint32_t ns) {
+        if (ns >= ClockThresholdNs)
+            spinClockNs(ns);
+        else
+            spinLoops((uint64_t(ns) * loopsPerNsQ16_) >> 16);
+    }
+
+    // CLOCK_MONOTONIC_RAW
+    static uint64_t nowNs();
+
+    // loops of the spin loop per microsecond
+    static double loopsPerUs() { return loopsPerNsQ16_ * 1000.0 / 65536; }
+
+private:
+    enum { ClockThresholdNs = 2000 };
+
+    static void spinLoops(uint32_t loops) {
+        for (uint32_t i = 0; i < loops; ++i) {
+            // keep the loop
+            __asm__ __volatile__("" ::: "memory");
+        }
+    }
+
+    static void spinClockNs(uint32_t ns);
+
+    // loops per nanosecond, fixed point 16.16
+    static uint32_t loopsPerNsQ16_;
+};
+
+} // namespace util
+
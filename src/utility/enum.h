@@ -4,7 +4,15 @@
 /***************  ENUM  *********************/
 enum LED_State:char {
     LED_ON  = 1,
-    LED_OFF = 0
+    LED_OFF = 0,
+
+    // LED on with a brightness level (1 ~ 15):  LED_LEVEL | level
+    LED_LEVEL = 0x10
+};
+
+enum {
+    LevelBits = 4,
+    MaxLevel  = 15
 };
 
 enum Direction {
@@ -61,3 +69,11 @@ enum Layer {
     LAYER_XY135 = 4
 };
 
+// how a layer of the Compositor is put over the ones below
+enum BlendMode {
+    BLEND_ERROR = -1,
+    BLEND_OR    = 0,    // lit if lit in either
+    BLEND_XOR   = 1,    // toggles the LEDs below
+    BLEND_OVER  = 2     // replaces the LEDs below, where its mask is set
+};
+
@@ -0,0 +1,130 @@
+#include "./font.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+enum { FontVersion = 1, MaxCode = 0x10FFFF };
+
+std::vector<Font*> Font::fonts;
+
+
+const Font* Font::load(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(FontHeader)) {
+        ::close(fd);
+        return nullptr;
+    }
+    size_t size = st.st_size;
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+        return nullptr;
+
+    const FontHeader* header = static_cast<const FontHeader*>(map);
+    uint64_t count = header->codeCount;
+    uint64_t needed = sizeof(FontHeader) + count * sizeof(ImageRows) + (count + 63) / 64 * sizeof(uint64_t);
+    bool ok = memcmp(header->magic, "LCFT", 4) == 0 &&
+              header->version == FontVersion &&
+              header->name[sizeof(header->name) - 1] == '\0' &&
+              header->firstCode <= MaxCode &&
+              count <= MaxCode + 1 - header->firstCode &&
+              needed <= size;
+    if (!ok) {
+        munmap(map, size);
+        return nullptr;
+    }
+
+    // the same font loaded twice
+    const Font* loaded = find(header->name);
+    if (loaded) {
+        munmap(map, size);
+        return loaded;
+    }
+
+    // glyphs are read here and there
+    madvise(map, size, MADV_RANDOM);
+
+    Font* font = new Font();
+    font->header_ = header;
+    font->glyphs_ = reinterpret_cast<const ImageRows*>(header + 1);
+    font->defined_ = reinterpret_cast<const uint64_t*>(font->glyphs_ + count);
+    fonts.push_back(font);
+    return font;
+}
+
+const Font* Font::find(const std::string& name) {
+    for (auto font : fonts) {
+        if (name == font->name())
+            return font;
+    }
+    return nullptr;
+}
+
+const Font* Font::findOrLoad(const std::string& nameOrPath) {
+    const Font* font = find(nameOrPath);
+    return font ? font : load(nameOrPath);
+}
+
+
+// the next code point of UTF-8 text, -1 if invalid (one byte skipped)
+static int nextCodePoint(const std::string& text, size_t& i) {
+    unsigned char ch = text[i++];
+    if (ch < 0x80)
+        return ch;
+
+    int extra, code;
+    if ((ch & 0xE0) == 0xC0)      { extra = 1; code = ch & 0x1F; }
+    else if ((ch & 0xF0) == 0xE0) { extra = 2; code = ch & 0x0F; }
+    else if ((ch & 0xF8) == 0xF0) { extra = 3; code = ch & 0x07; }
+    else
+        return -1;
+
+    if (i + extra > text.size())
+        return -1;
+    for (int k = 0; k < extra; ++k) {
+        unsigned char next = text[i + k];
+        if ((next & 0xC0) != 0x80)
+            return -1;
+        code = (code << 6) | (next & 0x3F);
+    }
+    i += extra;
+    return code;
+}
+
+// -1 if neither the font nor ImageLib has it
+static int resolve(const Font* font, int code) {
+    if (font->exist(code))
+        return code;
+    if (code < 0x80 && ImageLib::exist(code))
+        return code;
+    if (code >= 'a' && code <= 'z')
+        return resolve(font, code - 32);
+    return -1;
+}
+
+std::vector<int> Font::toImagesCode(const std::string& text, const Font* font) {
+    std::vector<int> imagesCode;
+    if (!font) {
+        std::string str = text;
+        ImageLib::validate(str);
+        imagesCode.reserve(str.size());
+        for (auto ch : str)
+            imagesCode.push_back(int(ch));
+        return imagesCode;
+    }
+
+    for (size_t i = 0; i < text.size(); ) {
+        int code = nextCodePoint(text, i);
+        if (code >= 0)
+            code = resolve(font, code);
+        if (code >= 0)
+            imagesCode.push_back(code);
+    }
+    return imagesCode;
+}
+
@@ -0,0 +1,77 @@
+#pragma once
+#include "./image_lib.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/*************************************************************
+ *   Font pack (.lcf), loaded at runtime
+ *
+ *     FontHeader
+ *     ImageRows  glyphs[codeCount]      glyph of firstCode + i
+ *     uint64_t   defined[(codeCount + 63) / 64]
+ *                bit i set if glyph i exists
+ *
+ *   Codes are Unicode code points, the glyphs are 8 bytes
+ *   like ImageLib's (one byte per row, bit 7 on the left).
+ *   Native byte order (the Pi and PCs are little-endian).
+ *   Built by tools/make_font.py (BDF, or hex rows)
+*************************************************************/
+struct FontHeader {
+    char magic[4];          // "LCFT"
+    uint16_t version;
+    uint16_t reserved;
+    char name[32];          // NUL terminated
+    uint32_t firstCode;
+    uint32_t codeCount;
+};
+
+
+/*************************************************************
+ *   Font
+ *     the file is mmap-ed, get() is an indexed load
+ *     fonts are loaded once and never unloaded
+*************************************************************/
+class Font {
+public:
+    // load a font pack, nullptr if it fails
+    // (the font already loaded if it has the same name)
+    static const Font* load(const std::string& filename);
+    // a loaded font, nullptr if none has this name
+    static const Font* find(const std::string& name);
+    // find(), else load() the path
+    static const Font* findOrLoad(const std::string& nameOrPath);
+
+    const char* name() const { return header_->name; }
+
+    bool exist(int code) const {
+        uint32_t i = uint32_t(code) - header_->firstCode;
+        return code >= 0 && i < header_->codeCount && (defined_[i / 64] >> (i % 64)) & 1;
+    }
+    // nullptr if the glyph doesn't exist
+    const ImageRows* get(int code) const {
+        return exist(code) ? &glyphs_[uint32_t(code) - header_->firstCode] : nullptr;
+    }
+
+    /*************************************************
+     *   Image codes of a text
+     *     font: UTF-8 code points in the font, else
+     *           in ImageLib (ASCII), else upper-cased
+     *     no font: ImageLib::validate()
+     *   the other characters are dropped
+    *************************************************/
+    static std::vector<int> toImagesCode(const std::string& text, const Font* font);
+
+private:
+    Font() {}
+    Font(const Font&) = delete;
+    Font& operator=(const Font&) = delete;
+
+    const FontHeader* header_ = nullptr;
+    const ImageRows* glyphs_ = nullptr;
+    const uint64_t* defined_ = nullptr;
+
+    static std::vector<Font*> fonts;
+};
+
@@ -0,0 +1,149 @@
+#include "./frame.h"
+#include "./glyph_cache.h"
+
+// byte y of every row
+static inline uint64_t columns(uint8_t byte) {
+    return uint64_t(0x0101010101010101ULL) * byte;
+}
+
+static inline uint64_t rotateLeft(uint64_t bits, int n) {
+    return n == 0 ? bits : (bits << n) | (bits >> (64 - n));
+}
+
+
+/*************************************************
+ *  Shift
+*************************************************/
+// the rows of each layer
+Frame Frame::shiftX(int n, bool wrap) const {
+    Frame result;
+    if (wrap) {
+        int k = ((n % 8) + 8) % 8;
+        for (int z = 0; z < 8; ++z)
+            result.layers[z] = rotateLeft(layers[z], k * 8);
+        return result;
+    }
+    for (int z = 0; z < 8; ++z) {
+        if (n >= 8 || n <= -8)
+            result.layers[z] = 0;
+        else
+            result.layers[z] = n >= 0 ? layers[z] << (n * 8) : layers[z] >> (-n * 8);
+    }
+    return result;
+}
+
+// the bits in each byte
+Frame Frame::shiftY(int n, bool wrap) const {
+    Frame result;
+    if (wrap) {
+        int k = ((n % 8) + 8) % 8;
+        uint64_t low = columns(uint8_t(0xFF << k));
+        for (int z = 0; z < 8; ++z) {
+            uint64_t layer = layers[z];
+            result.layers[z] = k == 0 ? layer : ((layer << k) & low) | ((layer >> (8 - k)) & ~low);
+        }
+        return result;
+    }
+    for (int z = 0; z < 8; ++z) {
+        if (n >= 8 || n <= -8)
+            result.layers[z] = 0;
+        else if (n >= 0)
+            result.layers[z] = (layers[z] << n) & columns(uint8_t(0xFF << n));
+        else
+            result.layers[z] = (layers[z] >> -n) & columns(uint8_t(0xFF >> -n));
+    }
+    return result;
+}
+
+// whole layers
+Frame Frame::shiftZ(int n, bool wrap) const {
+    Frame result;
+    for (int z = 0; z < 8; ++z) {
+        int from = z - n;
+        if (wrap)
+            from = ((from % 8) + 8) % 8;
+        result.layers[z] = (from >= 0 && from < 8) ? layers[from] : 0;
+    }
+    return result;
+}
+
+
+/*************************************************
+ *  Mirror and rotate
+ *    a layer is an 8x8 bit matrix [x][y], see
+ *    GlyphCache::transpose(), flipRows(), ...
+*************************************************/
+Frame Frame::mirrorX() const {
+    Frame result;
+    for (int z = 0; z < 8; ++z)
+        result.layers[z] = GlyphCache::flipRows(layers[z]);
+    return result;
+}
+
+Frame Frame::mirrorY() const {
+    Frame result;
+    for (int z = 0; z < 8; ++z)
+        result.layers[z] = GlyphCache::flipCols(layers[z]);
+    return result;
+}
+
+Frame Frame::mirrorZ() const {
+    Frame result;
+    for (int z = 0; z < 8; ++z)
+        result.layers[z] = layers[7 - z];
+    return result;
+}
+
+// byte x of layer z ==> byte z of layer x:
+// the 8x8 byte matrix transposed by blocks of 4, 2, 1
+Frame Frame::swapXZ() const {
+    Frame result = *this;
+    uint64_t* w = result.layers;
+    for (int i = 0; i < 4; ++i) {
+        uint64_t t = ((w[i] >> 32) ^ w[i + 4]) & 0x00000000FFFFFFFFULL;
+        w[i] ^= t << 32;
+        w[i + 4] ^= t;
+    }
+    for (int i : { 0, 1, 4, 5 }) {
+        uint64_t t = ((w[i] >> 16) ^ w[i + 2]) & 0x0000FFFF0000FFFFULL;
+        w[i] ^= t << 16;
+        w[i + 2] ^= t;
+    }
+    for (int i = 0; i < 8; i += 2) {
+        uint64_t t = ((w[i] >> 8) ^ w[i + 1]) & 0x00FF00FF00FF00FFULL;
+        w[i] ^= t << 8;
+        w[i + 1] ^= t;
+    }
+    return result;
+}
+
+// (x, y) ==> (7 - y, x)
+Frame Frame::rotateZ(int quarters) const {
+    Frame result = *this;
+    for (int q = ((quarters % 4) + 4) % 4; q > 0; --q) {
+        for (int z = 0; z < 8; ++z)
+            result.layers[z] = GlyphCache::flipRows(GlyphCache::transpose(result.layers[z]));
+    }
+    return result;
+}
+
+// (y, z) ==> (7 - z, y): x <==> z, then (x, y) ==> (y, 7 - x), then back
+Frame Frame::rotateX(int quarters) const {
+    Frame result = *this;
+    for (int q = ((quarters % 4) + 4) % 4; q > 0; --q) {
+        result = result.swapXZ();
+        for (int z = 0; z < 8; ++z)
+            result.layers[z] = GlyphCache::flipCols(GlyphCache::transpose(result.layers[z]));
+        result = result.swapXZ();
+    }
+    return result;
+}
+
+// (z, x) ==> (7 - x, z): x <==> z, then z ==> 7 - z
+Frame Frame::rotateY(int quarters) const {
+    Frame result = *this;
+    for (int q = ((quarters % 4) + 4) % 4; q > 0; --q)
+        result = result.swapXZ().mirrorZ();
+    return result;
+}
+
@@ -0,0 +1,165 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include "./enum.h"
+
+
+/*******************************************************
+ *   Frame: state of all the 512 LEDs, bit-packed
+ *
+ *     one uint64_t per layer z  (8 x 8 bytes = 64 bytes)
+ *     one byte per row x in the layer
+ *     one bit  per led y in the row
+ *
+ *     layers[z] bit (x * 8 + y) <==> led (x, y, z)
+*******************************************************/
+struct Frame {
+    uint64_t layers[8];
+
+    static uint64_t mask(int x, int y) {
+        return uint64_t(1) << (x * 8 + y);
+    }
+
+    bool get(int x, int y, int z) const {
+        return (layers[z] & mask(x, y)) != 0;
+    }
+
+    void set(int x, int y, int z, bool on) {
+        if (on)
+            layers[z] |= mask(x, y);
+        else
+            layers[z] &= ~mask(x, y);
+    }
+
+    // row x in layer z (bit y <==> led (x, y, z))
+    uint8_t row(int x, int z) const {
+        return uint8_t(layers[z] >> (x * 8));
+    }
+
+    void clear() {
+        memset(layers, 0, sizeof(layers));
+    }
+
+    /*********************************************
+     *   Whole frame at once, 128 bits at a time
+     *   (GCC vector extension: NEON / SSE)
+     *     fill(mask):         on where mask is set
+     *     erase(mask):        off where mask is set
+     *     blend(mask, image): image where mask is set
+    *********************************************/
+    void fill(const Frame& mask) {
+        for (int i = 0; i < 8; i += 2) {
+            Lanes a, m;
+            load(i, a);
+            mask.load(i, m);
+            store(i, a | m);
+        }
+    }
+
+    void erase(const Frame& mask) {
+        for (int i = 0; i < 8; i += 2) {
+            Lanes a, m;
+            load(i, a);
+            mask.load(i, m);
+            store(i, a & ~m);
+        }
+    }
+
+    void blend(const Frame& mask, const Frame& image) {
+        for (int i = 0; i < 8; i += 2) {
+            Lanes a, m, b;
+            load(i, a);
+            mask.load(i, m);
+            image.load(i, b);
+            store(i, (a & ~m) | (b & m));
+        }
+    }
+
+    /*********************************************
+     *   Bitwise, whole frames (see fill())
+    *********************************************/
+    Frame& operator|=(const Frame& other) {
+        fill(other);
+        return *this;
+    }
+
+    Frame& operator&=(const Frame& other) {
+        for (int i = 0; i < 8; i += 2) {
+            Lanes a, b;
+            load(i, a);
+            other.load(i, b);
+            store(i, a & b);
+        }
+        return *this;
+    }
+
+    Frame& operator^=(const Frame& other) {
+        for (int i = 0; i < 8; i += 2) {
+            Lanes a, b;
+            load(i, a);
+            other.load(i, b);
+            store(i, a ^ b);
+        }
+        return *this;
+    }
+
+    Frame operator~() const {
+        Frame result;
+        for (int i = 0; i < 8; i += 2) {
+            Lanes a;
+            load(i, a);
+            result.store(i, ~a);
+        }
+        return result;
+    }
+
+    Frame operator|(const Frame& other) const { Frame result = *this; return result |= other; }
+    Frame operator&(const Frame& other) const { Frame result = *this; return result &= other; }
+    Frame operator^(const Frame& other) const { Frame result = *this; return result ^= other; }
+
+    /*********************************************
+     *   Transforms, a new Frame (frame.cpp)
+     *     shiftX/Y/Z(n): n LEDs along the axis
+     *       (toward 0 if n < 0), the LEDs pushed
+     *       out are lost, or come back on the
+     *       other side if wrap
+     *     rotateX/Y/Z(quarters): quarters * 90
+     *       degrees about the axis through the
+     *       center (rotateZ(1): +x ==> +y)
+     *     mirrorX/Y/Z(): x ==> 7 - x, ...
+     *   e.g. scroll up:  leds = leds.shiftZ(1, true);
+    *********************************************/
+    Frame shiftX(int n, bool wrap = false) const;
+    Frame shiftY(int n, bool wrap = false) const;
+    Frame shiftZ(int n, bool wrap = false) const;
+
+    Frame rotateX(int quarters = 1) const;
+    Frame rotateY(int quarters = 1) const;
+    Frame rotateZ(int quarters = 1) const;
+
+    Frame mirrorX() const;
+    Frame mirrorY() const;
+    Frame mirrorZ() const;
+
+    bool operator==(const Frame& other) const {
+        return memcmp(layers, other.layers, sizeof(layers)) == 0;
+    }
+    bool operator!=(const Frame& other) const {
+        return !(*this == other);
+    }
+
+private:
+    typedef uint64_t Lanes __attribute__((vector_size(16)));
+
+    // x <==> z
+    Frame swapXZ() const;
+
+    // layers[i], layers[i + 1]
+    void load(int i, Lanes& lanes) const {
+        memcpy(&lanes, &layers[i], sizeof(lanes));
+    }
+    void store(int i, const Lanes& lanes) {
+        memcpy(&layers[i], &lanes, sizeof(lanes));
+    }
+};
+
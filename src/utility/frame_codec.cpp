@@ -0,0 +1,80 @@
+#include "./frame_codec.h"
+#include <cstring>
+
+
+void FrameCodec::pack(const Frame& leds, const uint64_t levels[8][LevelBits], uint64_t words[Words]) {
+    memcpy(words, leds.layers, sizeof(leds.layers));
+    memcpy(words + 8, levels, sizeof(uint64_t) * 8 * LevelBits);
+}
+
+void FrameCodec::unpack(const uint64_t words[Words], Frame& leds, uint64_t levels[8][LevelBits]) {
+    memcpy(leds.layers, words, sizeof(leds.layers));
+    memcpy(levels, words + 8, sizeof(uint64_t) * 8 * LevelBits);
+}
+
+void FrameCodec::keyReference(uint64_t words[Words]) {
+    for (int i = 0; i < 8; ++i)
+        words[i] = 0;
+    for (int i = 8; i < Words; ++i)
+        words[i] = ~uint64_t(0);
+}
+
+
+size_t FrameCodec::encode(const uint64_t frame[Words], const uint64_t reference[Words], uint8_t* out) {
+    uint64_t delta[Words];
+    for (int i = 0; i < Words; ++i)
+        delta[i] = frame[i] ^ reference[i];
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(delta);
+
+    uint8_t* start = out;
+    int pos = 0;
+    while (pos < Bytes) {
+        // zeros, a whole word at a time when possible
+        int zeros = pos;
+        while (zeros < Bytes) {
+            if ((zeros & 7) == 0 && delta[zeros >> 3] == 0)
+                zeros += 8;
+            else if (bytes[zeros] == 0)
+                ++zeros;
+            else
+                break;
+        }
+        // literals, until two zeros in a row (a single zero
+        // costs less as a literal than as a new run)
+        int literals = zeros;
+        while (literals < Bytes) {
+            if (bytes[literals] != 0)
+                ++literals;
+            else if (literals + 1 < Bytes && bytes[literals + 1] != 0)
+                literals += 2;
+            else
+                break;
+        }
+
+        out = putVarint(out, zeros - pos);
+        out = putVarint(out, literals - zeros);
+        memcpy(out, bytes + zeros, literals - zeros);
+        out += literals - zeros;
+        pos = literals;
+    }
+    return out - start;
+}
+
+const uint8_t* FrameCodec::decode(const uint8_t* in, const uint8_t* end, uint64_t words[Words]) {
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(words);
+    uint64_t pos = 0;
+    while (pos < Bytes) {
+        uint64_t zeros, literals;
+        if (!(in = getVarint(in, end, zeros)) || !(in = getVarint(in, end, literals)))
+            return nullptr;
+        if (zeros > Bytes - pos || literals > Bytes - pos - zeros || uint64_t(end - in) < literals)
+            return nullptr;
+        pos += zeros;
+        for (uint64_t i = 0; i < literals; ++i)
+            bytes[pos + i] ^= in[i];
+        in += literals;
+        pos += literals;
+    }
+    return pos == Bytes ? in : nullptr;
+}
+
@@ -0,0 +1,72 @@
+#pragma once
+#include "./enum.h"
+#include "./frame.h"
+#include <cstddef>
+#include <cstdint>
+
+
+/*************************************************************
+ *   FrameCodec
+ *     compress a frame against a reference frame
+ *
+ *   A frame is seen as Words uint64_t:
+ *     leds.layers[8], then levels[8][LevelBits]
+ *
+ *   encode():
+ *     delta = frame ^ reference, as Bytes bytes
+ *     then runs of  [varint zeros][varint n][n literal bytes]
+ *     until the Bytes bytes are covered
+ *
+ *   Consecutive frames of an effect differ by a few LEDs,
+ *   so a delta is mostly zeros: usually 3 ~ 10 bytes.
+ *
+ *   Keyframe: encoded against keyReference() (the cleared
+ *   cube) instead of the previous frame, it can be decoded
+ *   on its own (seeking).
+*************************************************************/
+class FrameCodec {
+public:
+    enum {
+        Words = 8 + 8 * LevelBits,
+        Bytes = Words * 8,
+        MaxEncodedSize = Bytes * 2 + 8,     // worst case, alternating bytes
+    };
+
+    static void pack(const Frame& leds, const uint64_t levels[8][LevelBits], uint64_t words[Words]);
+    static void unpack(const uint64_t words[Words], Frame& leds, uint64_t levels[8][LevelBits]);
+
+    // all off, brightness MaxLevel
+    static void keyReference(uint64_t words[Words]);
+
+    // out: at least MaxEncodedSize bytes, return the encoded size
+    static size_t encode(const uint64_t frame[Words], const uint64_t reference[Words], uint8_t* out);
+
+    // words ^= the decoded delta
+    // return the end of the encoded frame, nullptr if broken
+    static const uint8_t* decode(const uint8_t* in, const uint8_t* end, uint64_t words[Words]);
+
+    /*************************
+     *  varint (LEB128)
+    *************************/
+    static uint8_t* putVarint(uint8_t* out, uint64_t value) {
+        while (value >= 0x80) {
+            *out++ = uint8_t(value) | 0x80;
+            value >>= 7;
+        }
+        *out++ = uint8_t(value);
+        return out;
+    }
+
+    // nullptr if broken
+    static const uint8_t* getVarint(const uint8_t* in, const uint8_t* end, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; in < end && shift < 64; shift += 7) {
+            uint8_t byte = *in++;
+            value |= uint64_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return in;
+        }
+        return nullptr;
+    }
+};
+
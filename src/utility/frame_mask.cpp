@@ -0,0 +1,96 @@
+#include "./frame_mask.h"
+#include <algorithm>
+
+// [min, max] of a and b, clipped to the cube (min > max if empty)
+static void clip(int a, int b, int& min, int& max) {
+    min = std::max(std::min(a, b), 0);
+    max = std::min(std::max(a, b), 7);
+}
+
+// bits [min, max] of a byte, or bytes [min, max] of a word (empty if min > max)
+static uint64_t spanBits(int min, int max) {
+    if (min > max)
+        return 0;
+    return (uint64_t(0xFF) >> (7 - max + min)) << min;
+}
+
+
+uint64_t FrameMask::rectBits(int minX, int maxX, int minY, int maxY) {
+    minX = std::max(minX, 0);
+    maxX = std::min(maxX, 7);
+    minY = std::max(minY, 0);
+    maxY = std::min(maxY, 7);
+    if (minX > maxX || minY > maxY)
+        return 0;
+    // bit 0 of each row x, times the bits of one row (no carry)
+    uint64_t rows = 0;
+    for (int x = minX; x <= maxX; ++x)
+        rows |= uint64_t(1) << (x * 8);
+    return rows * spanBits(minY, maxY);
+}
+
+Frame FrameMask::planeX(int x) {
+    Frame mask;
+    for (int z = 0; z < 8; ++z)
+        mask.layers[z] = rowBits(x);
+    return mask;
+}
+
+Frame FrameMask::planeY(int y) {
+    Frame mask;
+    for (int z = 0; z < 8; ++z)
+        mask.layers[z] = colBits(y);
+    return mask;
+}
+
+Frame FrameMask::planeZ(int z) {
+    Frame mask;
+    mask.clear();
+    if (z >= 0 && z < 8)
+        mask.layers[z] = ~uint64_t(0);
+    return mask;
+}
+
+Frame FrameMask::box(const Coordinate& A, const Coordinate& B) {
+    int minX, maxX, minY, maxY, minZ, maxZ;
+    clip(A.x, B.x, minX, maxX);
+    clip(A.y, B.y, minY, maxY);
+    clip(A.z, B.z, minZ, maxZ);
+    uint64_t layer = rectBits(minX, maxX, minY, maxY);
+
+    Frame mask;
+    for (int z = 0; z < 8; ++z)
+        mask.layers[z] = (z >= minZ && z <= maxZ) ? layer : 0;
+    return mask;
+}
+
+// the box, less the box one LED inside
+Frame FrameMask::shell(const Coordinate& A, const Coordinate& B) {
+    Coordinate min(std::min(A.x, B.x), std::min(A.y, B.y), std::min(A.z, B.z));
+    Coordinate max(std::max(A.x, B.x), std::max(A.y, B.y), std::max(A.z, B.z));
+    Frame mask = box(min, max);
+    if (max.x - min.x > 1 && max.y - min.y > 1 && max.z - min.z > 1)
+        mask.erase(box({ min.x + 1, min.y + 1, min.z + 1 }, { max.x - 1, max.y - 1, max.z - 1 }));
+    return mask;
+}
+
+// the LEDs of the box on two of its faces at least
+Frame FrameMask::edges(const Coordinate& A, const Coordinate& B) {
+    Coordinate min(std::min(A.x, B.x), std::min(A.y, B.y), std::min(A.z, B.z));
+    Coordinate max(std::max(A.x, B.x), std::max(A.y, B.y), std::max(A.z, B.z));
+    uint64_t layer = rectBits(min.x, max.x, min.y, max.y);
+    uint64_t sideX = layer & (rowBits(min.x) | rowBits(max.x));
+    uint64_t sideY = layer & (colBits(min.y) | colBits(max.y));
+
+    Frame mask;
+    for (int z = 0; z < 8; ++z) {
+        if (z == min.z || z == max.z)
+            mask.layers[z] = sideX | sideY;
+        else if (z > min.z && z < max.z)
+            mask.layers[z] = sideX & sideY;
+        else
+            mask.layers[z] = 0;
+    }
+    return mask;
+}
+
@@ -0,0 +1,43 @@
+#pragma once
+#include "./coordinate.h"
+#include "./frame.h"
+
+
+/*************************************************************
+ *   FrameMask
+ *     the LEDs of a shape, as a Frame, to be applied with
+ *     Frame::fill() / erase() / blend() (or LedCube::lightMask())
+ *
+ *   A and B are opposite corners of an axis-aligned box, in
+ *   any order. The LEDs outside the cube are left out.
+ *   A flat box is a rectangle, a thin one is a row.
+*************************************************************/
+class FrameMask {
+public:
+    static Frame planeX(int x);
+    static Frame planeY(int y);
+    static Frame planeZ(int z);
+
+    // all the LEDs in the box
+    static Frame box(const Coordinate& A, const Coordinate& B);
+    // its 6 faces
+    static Frame shell(const Coordinate& A, const Coordinate& B);
+    // its 12 edges (the outline of a rectangle)
+    static Frame edges(const Coordinate& A, const Coordinate& B);
+
+    /*************************
+     *  bits of a layer
+     *  (0 outside the cube)
+    *************************/
+    // row x
+    static uint64_t rowBits(int x) {
+        return (x >= 0 && x < 8) ? uint64_t(0xFF) << (x * 8) : 0;
+    }
+    // column y
+    static uint64_t colBits(int y) {
+        return (y >= 0 && y < 8) ? uint64_t(0x0101010101010101ULL) << y : 0;
+    }
+    // x in [minX, maxX], y in [minY, maxY] (empty if min > max)
+    static uint64_t rectBits(int minX, int maxX, int minY, int maxY);
+};
+
@@ -0,0 +1,106 @@
+#include "./glyph_cache.h"
+#include "./font.h"
+#include "./image_lib.h"
+
+enum {
+    TRANSPOSE = 1,
+    FLIP_ROWS = 2,      // applied after TRANSPOSE
+    FLIP_COLS = 4
+};
+
+// [direction][angle / 90]
+//   the orientations of LedCube::getImageInLayerX/Y/Z, the image
+//   read as in ImageLib (row 0 at the top, column 0 on the left)
+static const int Transforms[6][4] = {
+    /* X_ASCEND  */ { FLIP_ROWS | FLIP_COLS, TRANSPOSE | FLIP_ROWS,             0,         TRANSPOSE | FLIP_COLS },
+    /* X_DESCEND */ { FLIP_ROWS,             TRANSPOSE | FLIP_ROWS | FLIP_COLS, FLIP_COLS, TRANSPOSE             },
+    /* Y_ASCEND  */ { FLIP_ROWS,             TRANSPOSE | FLIP_ROWS | FLIP_COLS, FLIP_COLS, TRANSPOSE             },
+    /* Y_DESCEND */ { FLIP_ROWS | FLIP_COLS, TRANSPOSE | FLIP_ROWS,             0,         TRANSPOSE | FLIP_COLS },
+    /* Z_ASCEND  */ { FLIP_COLS,             TRANSPOSE,                         FLIP_ROWS, TRANSPOSE | FLIP_ROWS | FLIP_COLS },
+    /* Z_DESCEND */ { 0,                     TRANSPOSE | FLIP_COLS,             FLIP_ROWS | FLIP_COLS, TRANSPOSE | FLIP_ROWS },
+};
+
+// ImageLib: row i, bit 7 first  ==>  bit (i * 8 + j)
+static uint64_t pack(const ImageRows& image) {
+    uint64_t bits = 0;
+    for (int i = 0; i < 8; ++i)
+        bits |= uint64_t(image.rows[i]) << (i * 8);
+    return GlyphCache::flipCols(bits);
+}
+
+
+int GlyphCache::variant(Direction viewDirection, Angle rotate) {
+    int d;
+    switch (viewDirection) {
+    case X_ASCEND:  d = 0; break;
+    case X_DESCEND: d = 1; break;
+    case Y_ASCEND:  d = 2; break;
+    case Y_DESCEND: d = 3; break;
+    case Z_ASCEND:  d = 4; break;
+    case Z_DESCEND: d = 5; break;
+    default: return -1;
+    }
+    switch (rotate) {
+    case ANGLE_0:   return d * Angles + 0;
+    case ANGLE_90:  return d * Angles + 1;
+    case ANGLE_180: return d * Angles + 2;
+    case ANGLE_270: return d * Angles + 3;
+    default: return -1;
+    }
+}
+
+uint64_t GlyphCache::orient(uint64_t bits, Direction viewDirection, Angle rotate) {
+    int v = variant(viewDirection, rotate);
+    if (v < 0)
+        return 0;
+    int transform = Transforms[v / Angles][v % Angles];
+    if (transform & TRANSPOSE)
+        bits = transpose(bits);
+    if (transform & FLIP_ROWS)
+        bits = flipRows(bits);
+    if (transform & FLIP_COLS)
+        bits = flipCols(bits);
+    return bits;
+}
+
+
+GlyphCache::GlyphCache() {
+    glyphs_.assign(size_t(ImageLib::Count) * Variants, 0);
+
+    static const Direction directions[] = { X_ASCEND, X_DESCEND, Y_ASCEND, Y_DESCEND, Z_ASCEND, Z_DESCEND };
+    static const Angle angles[] = { ANGLE_0, ANGLE_90, ANGLE_180, ANGLE_270 };
+    for (int code = 0; code < ImageLib::Count; ++code) {
+        if (!ImageLib::exist(code))
+            continue;
+        uint64_t bits = pack(ImageLib::get(code));
+        uint64_t* variants = &glyphs_[size_t(code) * Variants];
+        for (auto direction : directions) {
+            for (auto angle : angles)
+                variants[variant(direction, angle)] = orient(bits, direction, angle);
+        }
+    }
+}
+
+const GlyphCache& GlyphCache::instance() {
+    static const GlyphCache cache;
+    return cache;
+}
+
+Glyph GlyphCache::get(int imageCode, Direction viewDirection, Angle rotate) {
+    const GlyphCache& cache = instance();
+    int v = variant(viewDirection, rotate);
+    if (v < 0)
+        return Glyph{ 0 };
+    size_t index = size_t(imageCode) * Variants + v;
+    if (imageCode < 0 || index >= cache.glyphs_.size())
+        index = size_t(' ') * Variants + v;
+    return Glyph{ cache.glyphs_[index] };
+}
+
+Glyph GlyphCache::get(const Font* font, int imageCode, Direction viewDirection, Angle rotate) {
+    const ImageRows* image = font ? font->get(imageCode) : nullptr;
+    if (!image)
+        return get(imageCode, viewDirection, rotate);
+    return Glyph{ orient(pack(*image), viewDirection, rotate) };
+}
+
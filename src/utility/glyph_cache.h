@@ -0,0 +1,93 @@
+#pragma once
+#include "./enum.h"
+#include <cstdint>
+#include <vector>
+
+class Font;
+
+
+/*************************************************************
+ *   Glyph: an 8x8 image packed in 64 bits
+ *     bit (i * 8 + j) <==> image[i][j]
+ *
+ *   In a layer (the same order as LedCube::Array2D_8_8):
+ *     layer Z: image[x][y], the bits of Frame::layers[z]
+ *     layer Y: image[z][x]
+ *     layer X: image[z][y]
+*************************************************************/
+struct Glyph {
+    uint64_t bits;
+
+    bool get(int i, int j) const {
+        return (bits >> (i * 8 + j)) & 1;
+    }
+
+    // row i (bit j <==> image[i][j])
+    uint8_t row(int i) const {
+        return uint8_t(bits >> (i * 8));
+    }
+};
+
+
+/*************************************************************
+ *   GlyphCache
+ *     every image of ImageLib, in every view direction and
+ *     rotation, oriented once (on first use)
+ *
+ *   get() is then a single indexed load, instead of
+ *   remapping the image element by element
+*************************************************************/
+class GlyphCache {
+public:
+    // all off if the direction or the angle is invalid
+    // (an unknown image code is ' ')
+    static Glyph get(int imageCode, Direction viewDirection, Angle rotate);
+    // the glyph of the font if it has one (oriented on the fly),
+    // else the image of ImageLib
+    static Glyph get(const Font* font, int imageCode, Direction viewDirection, Angle rotate);
+
+    // build the cache now, instead of on the first get()
+    static void warmUp() { instance(); }
+
+    // the variant of an image seen from viewDirection, rotated
+    static uint64_t orient(uint64_t bits, Direction viewDirection, Angle rotate);
+
+    /*************************
+     *  bit transforms
+    *************************/
+    // image[i][j] ==> image[j][i]
+    static uint64_t transpose(uint64_t bits) {
+        uint64_t t;
+        t = (bits ^ (bits >> 7)) & 0x00AA00AA00AA00AAULL;
+        bits ^= t ^ (t << 7);
+        t = (bits ^ (bits >> 14)) & 0x0000CCCC0000CCCCULL;
+        bits ^= t ^ (t << 14);
+        t = (bits ^ (bits >> 28)) & 0x00000000F0F0F0F0ULL;
+        bits ^= t ^ (t << 28);
+        return bits;
+    }
+
+    // image[i][j] ==> image[7-i][j]
+    static uint64_t flipRows(uint64_t bits) {
+        return __builtin_bswap64(bits);
+    }
+
+    // image[i][j] ==> image[i][7-j]
+    static uint64_t flipCols(uint64_t bits) {
+        bits = ((bits >> 1) & 0x5555555555555555ULL) | ((bits & 0x5555555555555555ULL) << 1);
+        bits = ((bits >> 2) & 0x3333333333333333ULL) | ((bits & 0x3333333333333333ULL) << 2);
+        bits = ((bits >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((bits & 0x0F0F0F0F0F0F0F0FULL) << 4);
+        return bits;
+    }
+
+private:
+    enum { Directions = 6, Angles = 4, Variants = Directions * Angles };
+
+    GlyphCache();
+    static const GlyphCache& instance();
+    // -1 if invalid
+    static int variant(Direction viewDirection, Angle rotate);
+
+    std::vector<uint64_t> glyphs_;   // [imageCode][variant]
+};
+
@@ -0,0 +1,88 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+
+/*************************************************************
+ *   Histogram of durations (nanoseconds)
+ *
+ *   fixed log2 buckets:
+ *     bucket 0:  0 ns
+ *     bucket i:  [2^(i-1), 2^i) ns
+ *
+ *   record() is a few relaxed atomic adds, cheap enough for
+ *   the refresh thread; any thread may read it meanwhile
+ *   (the numbers are then only approximately consistent).
+*************************************************************/
+class Histogram {
+public:
+    enum { Buckets = 40 };   // up to 2^39 ns (~9 minutes)
+
+    Histogram() { reset(); }
+
+    void record(uint64_t ns) {
+        int b = ns ? 64 - __builtin_clzll(ns) : 0;
+        if (b >= Buckets)
+            b = Buckets - 1;
+        buckets_[b].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (ns > max && !max_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+            //;
+        }
+    }
+
+    void reset() {
+        for (int b = 0; b < Buckets; ++b)
+            buckets_[b].store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    uint64_t mean() const {
+        uint64_t n = count();
+        return n ? sum_.load(std::memory_order_relaxed) / n : 0;
+    }
+
+    // upper bound of the bucket holding the p-th percentile (0 ~ 100)
+    uint64_t percentile(double p) const {
+        uint64_t n = count();
+        if (n == 0)
+            return 0;
+        uint64_t rank = uint64_t(n * p / 100);
+        uint64_t seen = 0;
+        for (int b = 0; b < Buckets; ++b) {
+            seen += buckets_[b].load(std::memory_order_relaxed);
+            if (seen > rank)
+                return upperBound(b);
+        }
+        return max();
+    }
+
+    // one summary line, then one line per non-empty bucket
+    void print(FILE* fp, const char* name) const {
+        fprintf(fp, "  %-16s count %-10llu mean %-10llu p50 <%-10llu p99 <%-10llu max %llu (ns)\n",
+                name, (unsigned long long)count(), (unsigned long long)mean(),
+                (unsigned long long)percentile(50), (unsigned long long)percentile(99),
+                (unsigned long long)max());
+        for (int b = 0; b < Buckets; ++b) {
+            uint64_t n = buckets_[b].load(std::memory_order_relaxed);
+            if (n)
+                fprintf(fp, "      < %-12llu %llu\n", (unsigned long long)upperBound(b), (unsigned long long)n);
+        }
+    }
+
+private:
+    static uint64_t upperBound(int b) { return uint64_t(1) << b; }
+
+    std::atomic<uint64_t> buckets_[Buckets];
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> max_;
+};
+
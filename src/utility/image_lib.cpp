@@ -1,81 +1,95 @@
 #include "./image_lib.h"
-#include "../utility/utils.h"
 
-std::map<int, std::array<std::array<char, 8>, 8>> ImageLib::table =
+// the tables below are built by constexpr functions at
+// compile time (C++11: one return statement, recursion)
+
+namespace {
+
+struct ImageEntry {
+    int code;
+    ImageRows image;
+};
+
+struct ImageKey {
+    const char* name;
+    int code;
+};
+
+constexpr ImageEntry Images[] =
 {
-    { '0', util::toBinary({ 0x1C, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x1C }) },
-    { '1', util::toBinary({ 0x08, 0x18, 0x08, 0x08, 0x08, 0x08, 0x08, 0x1C }) },
-    { '2', util::toBinary({ 0x1C, 0x22, 0x02, 0x02, 0x1C, 0x20, 0x20, 0x3E }) },
-    { '3', util::toBinary({ 0x1C, 0x22, 0x02, 0x1C, 0x02, 0x02, 0x22, 0x1C }) },
-    { '4', util::toBinary({ 0x08, 0x18, 0x28, 0x48, 0x7C, 0x08, 0x08, 0x08 }) },
-    { '5', util::toBinary({ 0x3E, 0x20, 0x20, 0x3E, 0x02, 0x02, 0x22, 0x1C }) },
-    { '6', util::toBinary({ 0x1C, 0x22, 0x20, 0x3C, 0x22, 0x22, 0x22, 0x1C }) },
-    { '7', util::toBinary({ 0x3E, 0x02, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10 }) },
-    { '8', util::toBinary({ 0x1C, 0x22, 0x22, 0x1C, 0x22, 0x22, 0x22, 0x1C }) },
-    { '9', util::toBinary({ 0x1C, 0x22, 0x22, 0x22, 0x1E, 0x02, 0x22, 0x1C }) },
-
-    { 'A', util::toBinary({ 0x00, 0x1C, 0x22, 0x22, 0x22, 0x3E, 0x22, 0x22 }) },
-    { 'B', util::toBinary({ 0x00, 0x3C, 0x22, 0x22, 0x3E, 0x22, 0x22, 0x3C }) },
-    { 'C', util::toBinary({ 0x00, 0x1C, 0x22, 0x20, 0x20, 0x20, 0x22, 0x1C }) },
-    { 'D', util::toBinary({ 0x00, 0x3C, 0x22, 0x22, 0x22, 0x22, 0x22, 0x3C }) },
-    { 'E', util::toBinary({ 0x00, 0x3E, 0x20, 0x20, 0x3E, 0x20, 0x20, 0x3E }) },
-    { 'F', util::toBinary({ 0x00, 0x3E, 0x20, 0x20, 0x3E, 0x20, 0x20, 0x20 }) },
-    { 'G', util::toBinary({ 0x00, 0x1C, 0x22, 0x20, 0x3E, 0x22, 0x22, 0x1C }) },
-    { 'H', util::toBinary({ 0x00, 0x22, 0x22, 0x22, 0x3E, 0x22, 0x22, 0x22 }) },
-    { 'I', util::toBinary({ 0x00, 0x1C, 0x08, 0x08, 0x08, 0x08, 0x08, 0x1C }) },
-    { 'J', util::toBinary({ 0x00, 0x3E, 0x08, 0x08, 0x08, 0x08, 0x28, 0x18 }) },
-    { 'K', util::toBinary({ 0x00, 0x20, 0x2C, 0x30, 0x20, 0x30, 0x2C, 0x20 }) },
-    { 'L', util::toBinary({ 0x00, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x3E }) },
-    { 'M', util::toBinary({ 0x00, 0x42, 0x66, 0x5A, 0x42, 0x42, 0x42, 0x42 }) },
-    //{ 'n', util::toBinary({ 0x00, 0x00, 0x2C, 0x32, 0x22, 0x22, 0x22, 0x22 }) },
-    { 'N', util::toBinary({ 0x00, 0x42, 0x62, 0x52, 0x52, 0x4A, 0x46, 0x42 }) },
-    //{ 'N', util::toBinary({ 0x00, 0x41, 0x61, 0x51, 0x49, 0x45, 0x43, 0x41 }) },
-    { 'O', util::toBinary({ 0x00, 0x1C, 0x22, 0x22, 0x22, 0x22, 0x22, 0x1C }) },
-    { 'P', util::toBinary({ 0x00, 0x3C, 0x22, 0x22, 0x3C, 0x20, 0x20, 0x20 }) },
-    { 'Q', util::toBinary({ 0x00, 0x1C, 0x22, 0x22, 0x22, 0x2A, 0x26, 0x1F }) },
-    { 'R', util::toBinary({ 0x00, 0x38, 0x24, 0x24, 0x38, 0x30, 0x28, 0x24 }) },
-    { 'S', util::toBinary({ 0x00, 0x1C, 0x22, 0x20, 0x1C, 0x02, 0x22, 0x1C }) },
-    { 'T', util::toBinary({ 0x00, 0x3E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08 }) },
-    { 'U', util::toBinary({ 0x00, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x3C }) },
-    { 'V', util::toBinary({ 0x00, 0x22, 0x22, 0x22, 0x14, 0x14, 0x08, 0x00 }) },
-    { 'W', util::toBinary({ 0x00, 0x41, 0x41, 0x49, 0x55, 0x55, 0x63, 0x41 }) },
-    { 'X', util::toBinary({ 0x00, 0x00, 0x42, 0x24, 0x18, 0x18, 0x24, 0x42 }) },
-    { 'Y', util::toBinary({ 0x00, 0x22, 0x22, 0x14, 0x08, 0x08, 0x08, 0x08 }) },
-    { 'Z', util::toBinary({ 0x00, 0x3E, 0x02, 0x04, 0x08, 0x10, 0x20, 0x3E }) },
-
-    { ' ', util::toBinary({ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }) },
-    { '!', util::toBinary({ 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x08 }) },
-
-    { Image_Fill , util::toBinary({ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF }) },
-
-    { Image_Square_Edge_1,  util::toBinary({ 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00 }) },
-    { Image_Square_Edge_2,  util::toBinary({ 0x00, 0x00, 0x3C, 0x24, 0x24, 0x3C, 0x00, 0x00 }) }, 
-    { Image_Square_Edge_3,  util::toBinary({ 0x00, 0x7E, 0x22, 0x22, 0x22, 0x22, 0x7E, 0x00 }) },
-    { Image_Square_Edge_4,  util::toBinary({ 0xFF, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0xFF }) },
-
-    { Image_Square_Solid_1, util::toBinary({ 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00 }) },
-    { Image_Square_Solid_2, util::toBinary({ 0x00, 0x00, 0x3C, 0x3C, 0x3C, 0x3C, 0x00, 0x00 }) },
-    { Image_Square_Solid_3, util::toBinary({ 0x00, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x00 }) },
-    { Image_Square_Solid_4, util::toBinary({ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF }) },
-
-    { Image_Circle_Edge_1,  util::toBinary({ 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00 }) },
-    { Image_Circle_Edge_2,  util::toBinary({ 0x00, 0x00, 0x18, 0x24, 0x24, 0x18, 0x00, 0x00 }) },
-    { Image_Circle_Edge_3,  util::toBinary({ 0x00, 0x18, 0x24, 0x42, 0x42, 0x24, 0x18, 0x00 }) }, 
-    { Image_Circle_Edge_4,  util::toBinary({ 0x3c, 0x42, 0x81, 0x81, 0x81, 0x81, 0x42, 0x3c }) }, 
-    { Image_Circle_Edge_5,  util::toBinary({ 0x81, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x81 }) },
-
-    { Image_Circle_Solid_1, util::toBinary({ 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00 }) },
-    { Image_Circle_Solid_2, util::toBinary({ 0x00, 0x00, 0x18, 0x3C, 0x3C, 0x18, 0x00, 0x00 }) },
-    { Image_Circle_Solid_3, util::toBinary({ 0x00, 0x18, 0x3C, 0x7E, 0x7E, 0x3C, 0x18, 0x00 }) },
-    { Image_Circle_Solid_4, util::toBinary({ 0x3c, 0x7E, 0xFF, 0xFF, 0xFF, 0xFF, 0x7E, 0x3C }) },
-    { Image_Circle_Solid_5, util::toBinary({ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF }) },
-
-    { Image_Like,        util::toBinary({ 0x04, 0x0C, 0x1C, 0xBF, 0xBF, 0xBE, 0xBC, 0xB8 }) },
-    { Image_Coin,        util::toBinary({ 0x3C, 0x42, 0xBD, 0x99, 0xBD, 0x99, 0x42, 0x3c }) },
-    { Image_Collection,  util::toBinary({ 0x18, 0x18, 0x3C, 0xFF, 0xFF, 0x3C, 0x7E, 0x66 }) }
+    { '0', {{ 0x1C, 0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x1C }} },
+    { '1', {{ 0x08, 0x18, 0x08, 0x08, 0x08, 0x08, 0x08, 0x1C }} },
+    { '2', {{ 0x1C, 0x22, 0x02, 0x02, 0x1C, 0x20, 0x20, 0x3E }} },
+    { '3', {{ 0x1C, 0x22, 0x02, 0x1C, 0x02, 0x02, 0x22, 0x1C }} },
+    { '4', {{ 0x08, 0x18, 0x28, 0x48, 0x7C, 0x08, 0x08, 0x08 }} },
+    { '5', {{ 0x3E, 0x20, 0x20, 0x3E, 0x02, 0x02, 0x22, 0x1C }} },
+    { '6', {{ 0x1C, 0x22, 0x20, 0x3C, 0x22, 0x22, 0x22, 0x1C }} },
+    { '7', {{ 0x3E, 0x02, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10 }} },
+    { '8', {{ 0x1C, 0x22, 0x22, 0x1C, 0x22, 0x22, 0x22, 0x1C }} },
+    { '9', {{ 0x1C, 0x22, 0x22, 0x22, 0x1E, 0x02, 0x22, 0x1C }} },
+
+    { 'A', {{ 0x00, 0x1C, 0x22, 0x22, 0x22, 0x3E, 0x22, 0x22 }} },
+    { 'B', {{ 0x00, 0x3C, 0x22, 0x22, 0x3E, 0x22, 0x22, 0x3C }} },
+    { 'C', {{ 0x00, 0x1C, 0x22, 0x20, 0x20, 0x20, 0x22, 0x1C }} },
+    { 'D', {{ 0x00, 0x3C, 0x22, 0x22, 0x22, 0x22, 0x22, 0x3C }} },
+    { 'E', {{ 0x00, 0x3E, 0x20, 0x20, 0x3E, 0x20, 0x20, 0x3E }} },
+    { 'F', {{ 0x00, 0x3E, 0x20, 0x20, 0x3E, 0x20, 0x20, 0x20 }} },
+    { 'G', {{ 0x00, 0x1C, 0x22, 0x20, 0x3E, 0x22, 0x22, 0x1C }} },
+    { 'H', {{ 0x00, 0x22, 0x22, 0x22, 0x3E, 0x22, 0x22, 0x22 }} },
+    { 'I', {{ 0x00, 0x1C, 0x08, 0x08, 0x08, 0x08, 0x08, 0x1C }} },
+    { 'J', {{ 0x00, 0x3E, 0x08, 0x08, 0x08, 0x08, 0x28, 0x18 }} },
+    { 'K', {{ 0x00, 0x20, 0x2C, 0x30, 0x20, 0x30, 0x2C, 0x20 }} },
+    { 'L', {{ 0x00, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x3E }} },
+    { 'M', {{ 0x00, 0x42, 0x66, 0x5A, 0x42, 0x42, 0x42, 0x42 }} },
+    //{ 'n', {{ 0x00, 0x00, 0x2C, 0x32, 0x22, 0x22, 0x22, 0x22 }} },
+    { 'N', {{ 0x00, 0x42, 0x62, 0x52, 0x52, 0x4A, 0x46, 0x42 }} },
+    //{ 'N', {{ 0x00, 0x41, 0x61, 0x51, 0x49, 0x45, 0x43, 0x41 }} },
+    { 'O', {{ 0x00, 0x1C, 0x22, 0x22, 0x22, 0x22, 0x22, 0x1C }} },
+    { 'P', {{ 0x00, 0x3C, 0x22, 0x22, 0x3C, 0x20, 0x20, 0x20 }} },
+    { 'Q', {{ 0x00, 0x1C, 0x22, 0x22, 0x22, 0x2A, 0x26, 0x1F }} },
+    { 'R', {{ 0x00, 0x38, 0x24, 0x24, 0x38, 0x30, 0x28, 0x24 }} },
+    { 'S', {{ 0x00, 0x1C, 0x22, 0x20, 0x1C, 0x02, 0x22, 0x1C }} },
+    { 'T', {{ 0x00, 0x3E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08 }} },
+    { 'U', {{ 0x00, 0x42, 0x42, 0x42, 0x42, 0x42, 0x42, 0x3C }} },
+    { 'V', {{ 0x00, 0x22, 0x22, 0x22, 0x14, 0x14, 0x08, 0x00 }} },
+    { 'W', {{ 0x00, 0x41, 0x41, 0x49, 0x55, 0x55, 0x63, 0x41 }} },
+    { 'X', {{ 0x00, 0x00, 0x42, 0x24, 0x18, 0x18, 0x24, 0x42 }} },
+    { 'Y', {{ 0x00, 0x22, 0x22, 0x14, 0x08, 0x08, 0x08, 0x08 }} },
+    { 'Z', {{ 0x00, 0x3E, 0x02, 0x04, 0x08, 0x10, 0x20, 0x3E }} },
+
+    { ' ', {{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }} },
+    { '!', {{ 0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x08 }} },
+
+    { Image_Fill , {{ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF }} },
+
+    { Image_Square_Edge_1,  {{ 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00 }} },
+    { Image_Square_Edge_2,  {{ 0x00, 0x00, 0x3C, 0x24, 0x24, 0x3C, 0x00, 0x00 }} }, 
+    { Image_Square_Edge_3,  {{ 0x00, 0x7E, 0x22, 0x22, 0x22, 0x22, 0x7E, 0x00 }} },
+    { Image_Square_Edge_4,  {{ 0xFF, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0xFF }} },
+
+    { Image_Square_Solid_1, {{ 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00 }} },
+    { Image_Square_Solid_2, {{ 0x00, 0x00, 0x3C, 0x3C, 0x3C, 0x3C, 0x00, 0x00 }} },
+    { Image_Square_Solid_3, {{ 0x00, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x00 }} },
+    { Image_Square_Solid_4, {{ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF }} },
+
+    { Image_Circle_Edge_1,  {{ 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00 }} },
+    { Image_Circle_Edge_2,  {{ 0x00, 0x00, 0x18, 0x24, 0x24, 0x18, 0x00, 0x00 }} },
+    { Image_Circle_Edge_3,  {{ 0x00, 0x18, 0x24, 0x42, 0x42, 0x24, 0x18, 0x00 }} }, 
+    { Image_Circle_Edge_4,  {{ 0x3c, 0x42, 0x81, 0x81, 0x81, 0x81, 0x42, 0x3c }} }, 
+    { Image_Circle_Edge_5,  {{ 0x81, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x81 }} },
+
+    { Image_Circle_Solid_1, {{ 0x00, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x00 }} },
+    { Image_Circle_Solid_2, {{ 0x00, 0x00, 0x18, 0x3C, 0x3C, 0x18, 0x00, 0x00 }} },
+    { Image_Circle_Solid_3, {{ 0x00, 0x18, 0x3C, 0x7E, 0x7E, 0x3C, 0x18, 0x00 }} },
+    { Image_Circle_Solid_4, {{ 0x3c, 0x7E, 0xFF, 0xFF, 0xFF, 0xFF, 0x7E, 0x3C }} },
+    { Image_Circle_Solid_5, {{ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF }} },
+
+    { Image_Like,        {{ 0x04, 0x0C, 0x1C, 0xBF, 0xBF, 0xBE, 0xBC, 0xB8 }} },
+    { Image_Coin,        {{ 0x3C, 0x42, 0xBD, 0x99, 0xBD, 0x99, 0x42, 0x3c }} },
+    { Image_Collection,  {{ 0x18, 0x18, 0x3C, 0xFF, 0xFF, 0x3C, 0x7E, 0x66 }} }
 };
 
-std::map<std::string, int> ImageLib::keyTable =
+constexpr ImageKey Keys[] =
 {
     { "NUM_0", Num_0 },
     { "NUM_1", Num_1 },
@@ -175,39 +189,136 @@ std::map<std::string, int> ImageLib::keyTable =
     { "IMAGE_COLLECTION",     Image_Collection },
 };
 
+enum {
+    ImageCount = sizeof(Images) / sizeof(Images[0]),
+    KeyCount   = sizeof(Keys) / sizeof(Keys[0]),
+};
 
-bool ImageLib::exist(int key) {
-    auto findIter = ImageLib::table.find(key);
-    return findIter != ImageLib::table.end();
+
+/*************************
+ *   0, 1, ..., N-1
+ *   (std::index_sequence is C++14)
+*************************/
+template <int... I> struct Seq {};
+
+template <class A, class B> struct Concat;
+template <int... I, int... J> struct Concat<Seq<I...>, Seq<J...>> {
+    using type = Seq<I..., int(sizeof...(I)) + J...>;
+};
+
+template <int N> struct MakeSeq {
+    using type = typename Concat<typename MakeSeq<N / 2>::type, typename MakeSeq<N - N / 2>::type>::type;
+};
+template <> struct MakeSeq<0> { using type = Seq<>; };
+template <> struct MakeSeq<1> { using type = Seq<0>; };
+
+
+/*************************
+ *   image table
+*************************/
+constexpr ImageRows imageOf(int code, int i = 0) {
+    return i == ImageCount ? ImageRows{{ 0 }} :
+           Images[i].code == code ? Images[i].image : imageOf(code, i + 1);
+}
+
+constexpr bool definedOf(int code, int i = 0) {
+    return i == ImageCount ? false :
+           Images[i].code == code ? true : definedOf(code, i + 1);
+}
+
+template <class S> struct ImageTable;
+template <int... I> struct ImageTable<Seq<I...>> {
+    static constexpr ImageRows table[sizeof...(I)] = { imageOf(I)... };
+    static constexpr bool defined[sizeof...(I)] = { definedOf(I)... };
+};
+template <int... I> constexpr ImageRows ImageTable<Seq<I...>>::table[sizeof...(I)];
+template <int... I> constexpr bool ImageTable<Seq<I...>>::defined[sizeof...(I)];
+
+using Table = ImageTable<MakeSeq<ImageLib::Count>::type>;
+
+
+/*************************
+ *   perfect hash of keys
+ *     FNV-1a of the upper-cased key, with a seed such that
+ *     no two keys share a slot (checked below, if it fails
+ *     after adding keys: try other seeds or more slots)
+*************************/
+enum : uint32_t {
+    KeySeed  = 2166136262u,
+    KeySlots = 512,
+    NoKey    = 0xFF,
+};
+
+constexpr char upper(char ch) {
+    return (ch >= 'a' && ch <= 'z') ? char(ch - 32) : ch;
+}
+
+constexpr uint32_t keyHash(const char* str, uint32_t hash = KeySeed) {
+    return *str ? keyHash(str + 1, (hash ^ uint8_t(upper(*str))) * 16777619u) : hash;
+}
+
+constexpr uint32_t slotOf(int key) {
+    return keyHash(Keys[key].name) & (KeySlots - 1);
+}
+
+constexpr bool differentSlots(int key, int other = 0) {
+    return other == KeyCount ? true :
+           (other != key && slotOf(other) == slotOf(key)) ? false : differentSlots(key, other + 1);
+}
+
+constexpr bool isPerfect(int key = 0) {
+    return key == KeyCount ? true : differentSlots(key) && isPerfect(key + 1);
+}
+
+static_assert(int(KeyCount) < int(NoKey), "too many keys for uint8_t slots");
+static_assert(isPerfect(), "keys collide in the hash, change KeySeed");
+
+constexpr uint8_t keyIn(uint32_t slot, int key = 0) {
+    return key == KeyCount ? uint8_t(NoKey) :
+           slotOf(key) == slot ? uint8_t(key) : keyIn(slot, key + 1);
 }
 
-const std::array<std::array<char, 8>, 8>& ImageLib::get(int key) {
-    auto findIter = ImageLib::table.find(key);
-    if (findIter == ImageLib::table.end()) {
-        return ImageLib::table[' '];
+template <class S> struct KeyTable;
+template <int... I> struct KeyTable<Seq<I...>> {
+    static constexpr uint8_t slots[sizeof...(I)] = { keyIn(I)... };
+};
+template <int... I> constexpr uint8_t KeyTable<Seq<I...>>::slots[sizeof...(I)];
+
+using Slots = KeyTable<MakeSeq<KeySlots>::type>;
+
+// -1 if not found
+//   the key matches if upper-cased it equals the name
+int findKey(const std::string& keyStr) {
+    uint8_t key = Slots::slots[keyHash(keyStr.c_str()) & (KeySlots - 1)];
+    if (key == NoKey)
+        return -1;
+    const char* name = Keys[key].name;
+    size_t i = 0;
+    for (; i < keyStr.size() && name[i]; ++i) {
+        if (name[i] != upper(keyStr[i]))
+            return -1;
     }
-    else
-        return findIter->second;
+    return (i == keyStr.size() && !name[i]) ? Keys[key].code : -1;
+}
+
+} // namespace
+
+
+bool ImageLib::exist(int key) {
+    return key >= 0 && key < Count && Table::defined[key];
+}
+
+const ImageRows& ImageLib::get(int key) {
+    return exist(key) ? Table::table[key] : Table::table[' '];
 }
 
 bool ImageLib::exist(const std::string& keyStr) {
-    std::string keyStrTmp = keyStr;
-    util::toUpperCase(keyStrTmp);
-    auto findIter = ImageLib::keyTable.find(keyStrTmp);
-    if (findIter == ImageLib::keyTable.end())
-        return false;
-    else
-        return exist(findIter->second);
+    int key = findKey(keyStr);
+    return key != -1 && exist(key);
 }
 
 int ImageLib::getKey(const std::string& keyStr) {
-    std::string keyStrTmp = keyStr;
-    util::toUpperCase(keyStrTmp);
-    auto findIter = ImageLib::keyTable.find(keyStrTmp);
-    if (findIter == ImageLib::keyTable.end())
-        return -1;
-    else
-        return findIter->second;
+    return findKey(keyStr);
 }
 
 void ImageLib::validate(std::string& str) {
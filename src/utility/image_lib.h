@@ -1,6 +1,6 @@
 #pragma once
-#include <map>
-#include <array>
+#include <cstdint>
+#include <string>
 
 
 enum {
@@ -57,19 +57,36 @@ enum {
     Image_Coin        = Image_Base + 31,
     Image_Collection  = Image_Base + 32,
 
+    Image_End         = Image_Base + 33,    // one past the last code
 };
 
 
+/*************************************************************
+ *   ImageRows: an 8x8 image, 8 bytes
+ *     one byte per row, top to bottom
+ *     bit 7 is the leftmost LED of the row
+*************************************************************/
+struct ImageRows {
+    uint8_t rows[8];
+};
+
+
+/*************************************************************
+ *   ImageLib
+ *     images in a flat table indexed by image code, built
+ *     at compile time (no work at static initialization)
+ *     keys ("LETTER_A", "IMAGE_COIN", ...) are found by a
+ *     perfect hash, case-insensitive
+*************************************************************/
 class ImageLib {
 public:
-    static const std::array<std::array<char, 8>, 8>& get(int ch);
+    enum { Count = Image_End };
+
+    // ' ' if the image doesn't exist
+    static const ImageRows& get(int key);
     static bool exist(int key);
     static bool exist(const std::string& keyStr);
+    // -1 if not found
     static int getKey(const std::string& keyStr);
     static void validate(std::string& str);
-
-public:
-    static std::map<std::string, int> keyTable;
-    static std::map<int, std::array<std::array<char, 8>, 8>> table;
 };
-
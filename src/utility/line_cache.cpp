@@ -0,0 +1,36 @@
+#include "./line_cache.h"
+#include "./utils.h"
+
+std::vector<Frame> LineCache::lines_;
+
+
+void LineCache::enable() {
+    if (enabled())
+        return;
+    std::vector<Frame> lines(size_t(Points) * Points);
+    for (int i = 0; i < Points; ++i) {
+        Coordinate start(i / 8 % 8, i % 8, i / 64);
+        for (int j = 0; j < Points; ++j) {
+            Coordinate end(j / 8 % 8, j % 8, j / 64);
+            lines[size_t(i) * Points + j] = rasterize(start, end);
+        }
+    }
+    lines_.swap(lines);
+}
+
+Frame LineCache::get(const Coordinate& start, const Coordinate& end) {
+    if (!enabled() || !start.isValid() || !end.isValid())
+        return rasterize(start, end);
+    return lines_[size_t(index(start)) * Points + index(end)];
+}
+
+Frame LineCache::rasterize(const Coordinate& start, const Coordinate& end) {
+    Frame line;
+    line.clear();
+    util::forEachPointOnLine3D(start, end, [&](const Coordinate& point) {
+        if (point.isValid())
+            line.layers[point.z] |= Frame::mask(point.x, point.y);
+    });
+    return line;
+}
+
@@ -0,0 +1,35 @@
+#pragma once
+#include "./coordinate.h"
+#include "./frame.h"
+#include <vector>
+
+
+/*************************************************************
+ *   LineCache
+ *     the Frame of the line between any two LEDs, for all
+ *     the 512 x 512 pairs (64 bytes each, 16 MB)
+ *
+ *   Optional: get() is a table lookup once enable() has
+ *   built the table, else the line is rasterized on the fly.
+ *   Either way nothing is allocated, and the points outside
+ *   the cube are left out.
+*************************************************************/
+class LineCache {
+public:
+    // build the table (at startup, before any get())
+    static void enable();
+    static bool enabled() { return !lines_.empty(); }
+
+    static Frame get(const Coordinate& start, const Coordinate& end);
+    static Frame rasterize(const Coordinate& start, const Coordinate& end);
+
+private:
+    enum { Points = 512 };
+
+    static int index(const Coordinate& point) {
+        return (point.z * 8 + point.x) * 8 + point.y;
+    }
+
+    static std::vector<Frame> lines_;   // [index(start)][index(end)]
+};
+
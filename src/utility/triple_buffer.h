@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+
+
+/*************************************************************
+ *   TripleBuffer
+ *     lock-free handoff of the latest value from one writer
+ *     thread to one reader thread
+ *
+ *   writer: fill back(), then publish()
+ *   reader: acquire(), then read front()
+ *
+ *   Neither side ever waits for the other, and the reader
+ *   always sees a complete value (the newest published one).
+*************************************************************/
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : back_(0), middle_(1), front_(2) {}
+
+    /*************************
+     *  writer side
+    *************************/
+    T& back() { return buffers_[back_]; }
+
+    // hand the back buffer over, take the spare one back
+    void publish() {
+        back_ = middle_.exchange(back_ | FreshBit, std::memory_order_acq_rel) & IndexMask;
+    }
+
+    /*************************
+     *  reader side
+    *************************/
+    const T& front() const { return buffers_[front_]; }
+
+    // switch to the newest published buffer
+    // return false (front() unchanged) if nothing was published since last time
+    bool acquire() {
+        if (!(middle_.load(std::memory_order_relaxed) & FreshBit))
+            return false;
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & IndexMask;
+        return true;
+    }
+
+private:
+    enum { IndexMask = 0x03, FreshBit = 0x04 };
+
+    T buffers_[3];
+    int back_;                  // owned by the writer
+    std::atomic<int> middle_;   // shared, index | FreshBit
+    int front_;                 // owned by the reader
+};
+
@@ -150,6 +150,12 @@ static const std::map<std::string, Layer> layerStrMap = {
     { "LAYER_XY135", LAYER_XY135 }
 };
 
+static const std::map<std::string, BlendMode> blendModeStrMap = {
+    { "BLEND_OR",   BLEND_OR   },
+    { "BLEND_XOR",  BLEND_XOR  },
+    { "BLEND_OVER", BLEND_OVER }
+};
+
 
 void toUpperCase(char* str, int len) {
     for (int i = 0; i < len; ++i) {
@@ -220,6 +226,15 @@ Layer getLayer(std::string layerStr) {
         return it->second;
 }
 
+BlendMode getBlendMode(std::string blendModeStr) {
+    toUpperCase(blendModeStr);
+    auto it = blendModeStrMap.find(blendModeStr);
+    if (it == blendModeStrMap.end())
+        return BLEND_ERROR;
+    else
+        return it->second;
+}
+
 
 Direction reverseDirection(Direction input) {
     return Direction(-1 * input);
@@ -228,100 +243,19 @@ Direction reverseDirection(Direction input) {
 
 // Generating points on a 3-D line
 // using Bresenham's Algorithm
-void getLine3D(const Coordinate& start, const Coordinate end, std::vector<Coordinate>& line) {
-    line.emplace_back(start);
-    int x1 = start.x, y1 = start.y, z1 = start.z;
-    int x2 = end.x, y2 = end.y, z2 = end.z;
-
-    int dx, dy, dz;
-    int sx, sy, sz;
-
-    if (x2 > x1) {
-        dx = x2 - x1;
-        sx = 1;
-    } else {
-        dx = x1 - x2;
-        sx = -1;
-    }
-
-    if (y2 > y1) {
-        dy = y2 - y1;
-        sy = 1;
-    } else {
-        dy = y1 - y2;
-        sy = -1;
-    }
-
-    if (z2 > z1) {
-        dz = z2 - z1;
-        sz = 1;
-    } else {
-        dz = z1 - z2;
-        sz = -1;
-    }
-
-	// Driving axis is X-axis"
-	if (dx >= dy && dx >= dz) {
-        printf("x\n");
-		int p1 = 2 * dy - dx;
-		int p2 = 2 * dz - dx;
-		while (x1 != x2) {
-			x1 += sx;
-			if (p1 >= 0) {
-				y1 += sy;
-				p1 -= 2 * dx;
-            }
-			if (p2 >= 0) {
-				z1 += sz;
-				p2 -= 2 * dx;
-            }
-			p1 += 2 * dy;
-			p2 += 2 * dz;
-            line.emplace_back(x1, y1, z1);
-        }
-    }
-
-	// Driving axis is Y-axis"
-	else if (dy >= dx && dy >= dz) {
-        printf("y\n");
-		int p1 = 2 * dx - dy;
-		int p2 = 2 * dz - dy;
-		while (y1 != y2) {
-			y1 += sy;
-			if (p1 >= 0) {
-				x1 += sx;
-				p1 -= 2 * dy;
-            }
-			if (p2 >= 0) {
-				z1 += sz;
-				p2 -= 2 * dy;
-            }
-			p1 += 2 * dx;
-			p2 += 2 * dz;
-            line.emplace_back(x1, y1, z1);
-        }
-    }
+int getLine3D(const Coordinate& start, const Coordinate& end, Coordinate* line, int maxPoints) {
+    int count = 0;
+    forEachPointOnLine3D(start, end, [&](const Coordinate& point) {
+        if (count < maxPoints)
+            line[count++] = point;
+    });
+    return count;
+}
 
-	// Driving axis is Z-axis"
-    else {
-        printf("z\n");
-		int p1 = 2 * dy - dz;
-		int p2 = 2 * dx - dz;
-		while (z1 != z2) {
-			z1 += sz;
-			if (p1 >= 0) {
-				y1 += sy;
-				p1 -= 2 * dz;
-            }
-			if (p2 >= 0) {
-				x1 += sz;
-				p2 -= 2 * dz;
-            }
-			p1 += 2 * dy;
-			p2 += 2 * dx;
-            line.emplace_back(x1, y1, z1);
-        }
-    }
+void getLine3D(const Coordinate& start, const Coordinate end, std::vector<Coordinate>& line) {
+    forEachPointOnLine3D(start, end, [&](const Coordinate& point) {
+        line.emplace_back(point);
+    });
 }
 
 
@@ -53,6 +53,7 @@ namespace util
     FillType getFillType(std::string fillType);
     ShapeType getShape(std::string shape);
     Layer getLayer(std::string layer);
+    BlendMode getBlendMode(std::string blendMode);
 
 
     // Get reversed direction
@@ -64,6 +65,43 @@ namespace util
 
     // Generating points on a 3-D line
     // using Bresenham's Algorithm
+    //   visit(point) for each point, from start to end
+    //   (no allocation)
+    template <typename Visitor>
+    void forEachPointOnLine3D(const Coordinate& start, const Coordinate& end, Visitor visit) {
+        int pos[3] = { start.x, start.y, start.z };
+        const int to[3] = { end.x, end.y, end.z };
+        int delta[3], step[3];
+        for (int i = 0; i < 3; ++i) {
+            delta[i] = to[i] > pos[i] ? to[i] - pos[i] : pos[i] - to[i];
+            step[i] = to[i] > pos[i] ? 1 : -1;
+        }
+
+        // the driving axis m, the others a and b
+        int m = (delta[0] >= delta[1] && delta[0] >= delta[2]) ? 0 : (delta[1] >= delta[2] ? 1 : 2);
+        int a = (m + 1) % 3, b = (m + 2) % 3;
+        int pa = 2 * delta[a] - delta[m];
+        int pb = 2 * delta[b] - delta[m];
+
+        visit(Coordinate(pos[0], pos[1], pos[2]));
+        while (pos[m] != to[m]) {
+            pos[m] += step[m];
+            if (pa >= 0) {
+                pos[a] += step[a];
+                pa -= 2 * delta[m];
+            }
+            if (pb >= 0) {
+                pos[b] += step[b];
+                pb -= 2 * delta[m];
+            }
+            pa += 2 * delta[a];
+            pb += 2 * delta[b];
+            visit(Coordinate(pos[0], pos[1], pos[2]));
+        }
+    }
+
+    // at most maxPoints in line[], returns the number of points
+    int getLine3D(const Coordinate& start, const Coordinate& end, Coordinate* line, int maxPoints);
     void getLine3D(const Coordinate& start, const Coordinate end, std::vector<Coordinate>& line);
 
 } // namespace util
@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""Build a font pack (.lcf) for led_cube --font=FILE.
+
+    make_font.py NAME INPUT OUTPUT
+
+NAME   the name of the font (<FONT> NAME in the eml files), 31 bytes at most
+INPUT  a BDF font (*.bdf), or a text file of glyphs, one per line:
+
+           U+0061  00 00 3C 02 3E 42 3E 00    # a
+
+       the code (U+XXXX, 0xXX, decimal, or the character itself), then
+       8 bytes in hex, one per row, top first, bit 7 on the left
+       (spaces between the bytes are optional, '#' starts a comment,
+       the glyph of '#' itself is written U+0023)
+
+The layout of the file (see src/utility/font.h), little-endian:
+
+    FontHeader  48 bytes
+        char     magic[4]      "LCFT"
+        uint16   version       1
+        uint16   reserved      0
+        char     name[32]      NUL terminated
+        uint32   firstCode     the smallest code
+        uint32   codeCount     the largest code - firstCode + 1
+    glyphs      8 bytes x codeCount, glyph of firstCode + i
+    defined     uint64 x ((codeCount + 63) / 64), bit i set if glyph i exists
+
+BDF glyphs are placed in the 8x8 cell by the font bounding box (its top
+left corner at the top left of the cell); pixels outside the cell are
+dropped with a warning.
+"""
+
+import struct
+import sys
+
+FONT_VERSION = 1
+MAX_CODE = 0x10FFFF
+
+
+def parse_code(token):
+    if token[:2] in ("U+", "u+"):
+        return int(token[2:], 16)
+    if token[:2] in ("0x", "0X"):
+        return int(token, 16)
+    if token.isdigit():
+        return int(token)
+    if len(token) == 1:
+        return ord(token)
+    raise ValueError("bad code: " + token)
+
+
+def read_text(filename):
+    glyphs = {}
+    with open(filename, encoding="utf-8") as f:
+        for number, line in enumerate(f, 1):
+            fields = line.split(None, 1)
+            if not fields or fields[0].startswith("#"):
+                continue
+            code = parse_code(fields[0])
+            digits = "".join(fields[1].split("#", 1)[0].split()) if len(fields) > 1 else ""
+            if len(digits) != 16:
+                raise ValueError("%s:%d: 8 bytes expected" % (filename, number))
+            glyphs[code] = bytes.fromhex(digits)
+    return glyphs
+
+
+def read_bdf(filename):
+    glyphs = {}
+    box = None
+    clipped = 0
+    with open(filename, encoding="latin-1") as f:
+        lines = iter(f.read().splitlines())
+    for line in lines:
+        fields = line.split()
+        if not fields:
+            continue
+        if fields[0] == "FONTBOUNDINGBOX":
+            box = [int(v) for v in fields[1:5]]
+        elif fields[0] == "STARTCHAR":
+            code, bbx = -1, box
+            for line in lines:
+                fields = line.split()
+                if not fields:
+                    continue
+                if fields[0] == "ENCODING":
+                    code = int(fields[1])
+                elif fields[0] == "BBX":
+                    bbx = [int(v) for v in fields[1:5]]
+                elif fields[0] == "BITMAP":
+                    break
+            bitmap = []
+            for line in lines:
+                if line.strip() == "ENDCHAR":
+                    break
+                bitmap.append(line.strip())
+            if code < 0 or box is None:
+                continue
+
+            width, height, xoff, yoff = bbx
+            # row 0 of the cell: the top of the font bounding box
+            top = (box[1] + box[3]) - (yoff + height)
+            left = xoff - box[2]
+            rows = bytearray(8)
+            for r, hexrow in enumerate(bitmap):
+                value = int(hexrow, 16)
+                bits = len(hexrow) * 4
+                for c in range(width):
+                    if not (value >> (bits - 1 - c)) & 1:
+                        continue
+                    y, x = top + r, left + c
+                    if 0 <= y < 8 and 0 <= x < 8:
+                        rows[y] |= 0x80 >> x
+                    else:
+                        clipped += 1
+            glyphs[code] = bytes(rows)
+    if clipped:
+        print("warning: %d pixels outside of 8x8 dropped" % clipped, file=sys.stderr)
+    return glyphs
+
+
+def write_lcf(filename, name, glyphs):
+    encoded = name.encode("utf-8")
+    if len(encoded) > 31:
+        raise ValueError("the name is longer than 31 bytes")
+    if not glyphs:
+        raise ValueError("no glyph")
+    first, last = min(glyphs), max(glyphs)
+    if first < 0 or last > MAX_CODE:
+        raise ValueError("code out of range")
+    count = last - first + 1
+
+    data = bytearray(struct.pack("<4sHH32sII", b"LCFT", FONT_VERSION, 0, encoded, first, count))
+    defined = [0] * ((count + 63) // 64)
+    for i in range(count):
+        rows = glyphs.get(first + i)
+        if rows is None:
+            data += bytes(8)
+        else:
+            data += rows
+            defined[i // 64] |= 1 << (i % 64)
+    data += struct.pack("<%dQ" % len(defined), *defined)
+
+    with open(filename, "wb") as f:
+        f.write(data)
+    return len(glyphs), count
+
+
+def main(argv):
+    if len(argv) != 4:
+        print("Usage: make_font.py NAME INPUT OUTPUT", file=sys.stderr)
+        return 1
+    name, source, output = argv[1:]
+    try:
+        glyphs = read_bdf(source) if source.lower().endswith(".bdf") else read_text(source)
+        defined, count = write_lcf(output, name, glyphs)
+    except (OSError, ValueError) as e:
+        print("make_font.py: %s" % e, file=sys.stderr)
+        return 1
+    print("%s: %d glyphs (%d codes)" % (output, defined, count))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -2,6 +2,14 @@
 -- Run on RaspberryPi (3B, 3B+, 4B)
 -- Need 40Pin version
 
+-- xmake f --wiringpi=n   to build without wiringPi (simulator backend only)
+option("wiringpi")
+    set_default(true)
+    set_showmenu(true)
+    set_description("Build the wiringPi backend (RaspberryPi only)")
+    add_defines("LEDCUBE_WITH_WIRINGPI")
+option_end()
+
 target("led_cube")
     set_kind("binary")
 
@@ -20,8 +28,26 @@ target("led_cube")
     set_targetdir(".")
 
     -- link flags
-    add_links("pthread", "wiringPi")
+    add_links("pthread")
+    add_options("wiringpi")
+    if has_config("wiringpi") then
+        add_links("wiringPi")
+    end
 
     add_mflags("-O3")
     
 
+-- GpioMemBackend checked on mock registers, no RaspberryPi needed
+--   xmake build gpio_mem_check && xmake run gpio_mem_check
+target("gpio_mem_check")
+    set_kind("binary")
+    set_default(false)
+
+    set_languages("c99", "cxx11")
+
+    add_files("tools/gpio_mem_check.cpp")
+    add_files("src/driver/backend/gpio_mem.cpp")
+    add_files("src/driver/backend/gpiomem_backend.cpp")
+
+    set_objectdir("build/objs")
+    set_targetdir("build")